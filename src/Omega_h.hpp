@@ -97,6 +97,67 @@ class Write {
 std::size_t get_current_bytes();
 std::size_t get_max_bytes();
 
+/* Write<T> allocations are charged to the innermost
+   ScopedMemoryLabel alive on the allocating thread,
+   or to "omega_h" if there is none. */
+class ScopedMemoryLabel {
+ public:
+  ScopedMemoryLabel(std::string const& name);
+  ~ScopedMemoryLabel();
+  ScopedMemoryLabel(ScopedMemoryLabel const&) = delete;
+  ScopedMemoryLabel& operator=(ScopedMemoryLabel const&) = delete;
+
+ private:
+  Int previous_;
+};
+
+struct MemoryLabelStats {
+  std::string label;
+  std::size_t current_bytes;
+  std::size_t max_bytes;
+  std::size_t bytes_at_peak;  // held when get_max_bytes() was reached
+  std::size_t nallocs;
+};
+
+std::vector<MemoryLabelStats> get_memory_report();
+void print_memory_report(std::ostream& stream);
+
+/* Without Kokkos, Write<T> storage can be recycled through
+   size-class free lists instead of going back to the system
+   allocator on every free, which pays off when the same array
+   sizes recur (e.g. across adapt() iterations).
+   Pooling is off by default; Omega_h_finalize() releases
+   whatever is retained. */
+struct PoolStats {
+  std::size_t nrequests;  // allocations made while pooling was enabled
+  std::size_t nhits;      // ... of which were served from a free list
+  std::size_t retained_bytes;
+  std::size_t max_retained_bytes;
+};
+void enable_pooling(bool yn);
+bool is_pooling_enabled();
+PoolStats get_pool_stats();
+void release_pooled_memory();
+
+/* A Mesh caches every adjacency, star and dual it is asked for.
+   Given a budget, each mesh evicts the least recently used ones
+   whenever their total size exceeds it, and derives them again when
+   they are next asked for. The downward adjacencies that define the
+   mesh are never evicted. There is no budget by default. */
+struct AdjCacheStats {
+  std::size_t nhits;
+  std::size_t nmisses;
+  std::size_t nrecomputes;  // ... of which had been evicted before
+  std::size_t nevictions;
+  std::size_t evicted_bytes;
+  double derive_seconds;     // spent on misses
+  double recompute_seconds;  // ... of which on recomputes
+};
+void set_adj_cache_budget(std::size_t bytes);
+std::size_t get_adj_cache_budget();
+AdjCacheStats get_adj_cache_stats();
+void reset_adj_cache_stats();
+
 template <typename T>
 OMEGA_H_INLINE Write<T>::Write()
     :
@@ -154,6 +215,27 @@ class Reals : public Read<Real> {
   Reals(std::initializer_list<Real> l);
 };
 
+/* an array of (size) boolean marks packed 32 to a word,
+   bit (i % 32) of word (i / 32) being mark (i).
+   bits past (size) in the last word are always zero */
+class Bits {
+  LO size_;
+  Read<I32> words_;
+
+ public:
+  OMEGA_H_INLINE Bits() : size_(0) {}
+  Bits(LO size, Read<I32> words);
+  explicit Bits(Read<I8> marks);
+  OMEGA_H_INLINE LO size() const { return size_; }
+  OMEGA_H_INLINE LO nwords() const { return (size_ + 31) / 32; }
+  OMEGA_H_INLINE Read<I32> words() const { return words_; }
+  OMEGA_H_DEVICE bool operator[](LO i) const {
+    return (words_[i / 32] >> (i % 32)) & 1;
+  }
+  OMEGA_H_INLINE bool exists() const { return words_.exists(); }
+  Read<I8> unpack() const;
+};
+
 template <typename T>
 class HostRead {
   Read<T> read_;
@@ -207,11 +289,29 @@ class HostWrite {
   T* data() const;
 };
 
+/* Tag names are interned: the first time a name is seen it gets a
+   small integer id, by which meshes find their tags in constant time.
+   A TagHandle<T> holds an interned name, so code that keeps asking for
+   the same tag can make one handle up front and do no string work
+   afterwards. A handle is good for any mesh and any dimension. */
+Int intern_tag_name(std::string const& name);
+Int find_tag_name(std::string const& name);  // (-1) if never interned
+std::string const& get_tag_name(Int name_id);
+
+template <typename T>
+struct TagHandle {
+  TagHandle() : name_id(-1) {}
+  explicit TagHandle(std::string const& name)
+      : name_id(intern_tag_name(name)) {}
+  Int name_id;
+};
+
 class TagBase {
  public:
   TagBase(std::string const& name, Int ncomps, Int xfer, Int outflags);
   virtual ~TagBase();
   std::string const& name() const;
+  Int name_id() const;
   Int ncomps() const;
   Int xfer() const;
   Int outflags() const;
@@ -219,6 +319,7 @@ class TagBase {
 
  private:
   std::string name_;
+  Int name_id_;
   Int ncomps_;
   Int xfer_;
   Int outflags_;
@@ -315,6 +416,10 @@ class Dist {
   LOs items2content_[2];
   LOs msgs2content_[2];
   CommPtr comm_[2];
+  LOs msgs2words_[2];
+  LOs words2msgs_[2];
+  LOs content2msgs_[2];
+  LOs content2roots_[2];
 
  public:
   Dist();
@@ -346,9 +451,12 @@ class Dist {
   LO nsrcs() const;
   void change_comm(CommPtr new_comm);
   Remotes exch(Remotes data, Int width) const;
+  Bits exch(Bits data) const;
 
  private:
   void copy(Dist const& other);
+  void set_msgs_layout(Int i);
+  void set_content2roots(Int i);
   enum { F, R };
 };
 
@@ -436,15 +544,24 @@ class Mesh {
   Read<T> get_array(Int dim, std::string const& name) const;
   void remove_tag(Int dim, std::string const& name);
   bool has_tag(Int dim, std::string const& name) const;
+  template <typename T>
+  bool has_tag(Int dim, TagHandle<T> tag) const;
+  template <typename T>
+  Read<T> get_array(Int dim, TagHandle<T> tag) const;
+  template <typename T>
+  void set_tag(
+      Int dim, TagHandle<T> tag, Read<T> array, bool internal = false);
   Int ntags(Int dim) const;
   TagBase const* get_tag(Int dim, Int i) const;
   bool has_ents(Int dim) const;
   bool has_adj(Int from, Int to) const;
+  bool adj_was_used(Int from, Int to) const;
   Adj get_adj(Int from, Int to) const;
   Adj ask_down(Int from, Int to);
   LOs ask_verts_of(Int dim);
   LOs ask_elem_verts();
   Adj ask_up(Int from, Int to);
+  void add_up(Int from, Int to, Adj up);
   Graph ask_star(Int dim);
   Graph ask_dual();
 
@@ -460,19 +577,29 @@ class Mesh {
   typedef TagVector::const_iterator TagCIter;
   TagIter tag_iter(Int dim, std::string const& name);
   TagCIter tag_iter(Int dim, std::string const& name) const;
+  Int tag_position(Int dim, Int name_id) const;
+  void index_tags(Int dim);
   void check_dim(Int dim) const;
   void check_dim2(Int dim) const;
   void add_adj(Int from, Int to, Adj adj);
   Adj derive_adj(Int from, Int to);
   Adj ask_adj(Int from, Int to);
-  void react_to_set_tag(Int dim, std::string const& name);
+  bool is_base_adj(Int from, Int to) const;
+  std::size_t adj_cache_bytes() const;
+  void evict_adjs(Int keep_from, Int keep_to);
+  void react_to_set_tag(Int dim, Int name_id);
   Int dim_;
   CommPtr comm_;
   Int parting_;
   Int nghost_layers_;
   LO nents_[DIMS];
   TagVector tags_[DIMS];
+  std::vector<Int> tag_positions_[DIMS];  // by interned name
   AdjPtr adjs_[DIMS][DIMS];
+  I64 adj_clock_;
+  I64 adj_last_use_[DIMS][DIMS];
+  bool adj_was_evicted_[DIMS][DIMS];
+  bool adj_was_used_[DIMS][DIMS];
   Remotes owners_[DIMS];
   DistPtr dists_[DIMS];
   RibPtr rib_hints_;
@@ -500,6 +627,7 @@ class Mesh {
   Graph ask_graph(Int from, Int to);
   template <typename T>
   Read<T> sync_array(Int ent_dim, Read<T> a, Int width);
+  Bits sync_array(Int ent_dim, Bits a);
   template <typename T>
   Read<T> sync_subset_array(
       Int ent_dim, Read<T> a_data, LOs a2e, T default_val, Int width);
@@ -566,6 +694,49 @@ class FullWriter {
 };
 }  // end namespace vtk
 
+/* A hierarchical region profiler.
+   While enabled, each live profile::Region becomes a node of a call
+   tree (keyed by the names of its enclosing regions) which accumulates
+   call counts, inclusive and exclusive wall time and the number of
+   bytes allocated by Write<T> while it was alive.
+   Constructing a Region while profiling is disabled costs a branch. */
+namespace profile {
+void enable(bool yn);
+bool is_enabled();
+/* zeroes all statistics, keeping the tree */
+void reset();
+/* collective over (comm); regions are matched by their path in the
+   tree of rank 0 and reported as min/avg/max over ranks */
+void print(CommPtr comm, std::ostream& stream);
+class Region {
+ public:
+  Region(char const* name);
+  ~Region();
+  Region(Region const&) = delete;
+  Region& operator=(Region const&) = delete;
+
+ private:
+  bool is_active_;
+  bool is_traced_;
+};
+}  // end namespace profile
+
+/* Chrome trace-event recording, viewable in chrome://tracing
+   or ui.perfetto.dev. While recording, every profile::Region
+   emits a begin/end pair and every parallel_for, parallel_reduce
+   and parallel_scan emits a complete event named after its functor.
+   When not recording, each of those pays one branch. */
+namespace tracing {
+/* collective over (comm), whose barrier sets the common time origin.
+   previously recorded events are discarded */
+void start(CommPtr comm);
+void stop();
+bool is_recording();
+/* collective over (comm). if (merged), rank 0 writes the events of all
+   ranks to (path), otherwise each rank writes its own to (path).(rank) */
+void write(CommPtr comm, std::string const& path, bool merged = true);
+}  // end namespace tracing
+
 enum Verbosity { SILENT, EACH_ADAPT, EACH_REBUILD, EXTRA_STATS };
 
 struct AdaptOpts {
@@ -579,10 +750,81 @@ struct AdaptOpts {
   Verbosity verbosity;
   Real length_histogram_min;
   Real length_histogram_max;
+  /* if not empty, only the elements with an entity classified on one
+     of these model entities, plus (nregion_layers) layers of elements
+     around them, are candidates for modification, and only their
+     lengths and qualities decide whether adapt() is done.
+     cavities may still reach one layer past the candidates. */
+  std::vector<Int> region_class_dims;
+  std::vector<I32> region_class_ids;
+  Int nregion_layers;
+  /* budgets, checked around each pass (one attempt at refining,
+     coarsening or swapping). once one is spent, adapt() stops.
+     only adapt(mesh, opts, stats) reports which one, in
+     AdaptStats::stop; the plain adapt() just prints it unless SILENT */
+  Int max_passes;    // counting only passes that modified the mesh
+  Real max_seconds;  // since adapt() was called, slowest rank
+  /* a pass that modified fewer than this fraction of the mesh
+     (edges split or swapped plus vertices collapsed, each relative
+     to the global count of its dimension) is the last one */
+  Real min_changed_fraction;
+  /* before addressing lengths, if the elements expected after
+     adapting (from the "size" or "metric" tag) on the most loaded
+     rank exceed this multiple of their average over ranks,
+     adapt() calls Mesh::balance(true) */
+  Real max_predicted_imbalance;
+};
+
+/* why adapt() stopped. ADAPT_DONE means no operation could make
+   further progress, which includes the mesh being good */
+enum AdaptStop {
+  ADAPT_DONE,
+  ADAPT_MAX_PASSES,
+  ADAPT_MAX_SECONDS,
+  ADAPT_FEW_CHANGES
+};
+
+/* one attempt at an operation inside adapt(), whether or not
+   it modified the mesh. key counts are global */
+struct AdaptPassStats {
+  /* one of "refine", "coarsen", "swap" or "coarsen_slivers" */
+  std::string operation;
+  bool modified;
+  GO nrefined;    // edges split
+  GO ncollapsed;  // vertices collapsed
+  GO nswapped;    // edges swapped
+  std::size_t nindset_rounds;
+  std::size_t nmigrations;
+  /* sent to other ranks by this rank, through every Dist::exch() */
+  std::size_t nbytes_moved;
+  Real seconds;
+};
+
+struct AdaptHistogram {
+  Real min;
+  Real max;
+  std::vector<GO> counts;  // of owned entities, per equal-width bucket
+};
+
+struct AdaptStats {
+  AdaptStop stop;
+  /* max over average of the expected elements per rank,
+     before balancing, or 1.0 if there was nothing to predict */
+  Real predicted_imbalance;
+  bool balanced;
+  std::vector<AdaptPassStats> passes;
+  Real lengths_seconds;
+  Real quality_seconds;
+  Real total_seconds;
+  AdaptHistogram quality_histogram;  // of elements, after adapting
+  AdaptHistogram length_histogram;   // of edges, after adapting
 };
 
 /* returns false if the mesh was not modified. */
 bool adapt(Mesh* mesh, AdaptOpts const& opts);
+/* same as above, and if (stats) is not null, overwrites it
+   with what adapt() did, regardless of verbosity */
+bool adapt(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats);
 
 namespace binary {
 void write(std::string const& path, Mesh* mesh);
@@ -602,6 +844,36 @@ void build_from_elems2verts(Mesh* mesh, Int edim, LOs ev2v, LO nverts);
 void build_from_elems_and_coords(Mesh* mesh, Int edim, LOs ev2v, Reals coords);
 void build_box(Mesh* mesh, Real x, Real y, Real z, LO nx, LO ny, LO nz);
 
+/* Deriving edges and faces from elements identifies the uses of each
+   one by matching sorted vertex lists. By default this sorts all uses,
+   and then matches uses to entities through upward adjacency.
+   Hashed matching puts the vertex lists in a concurrent hash table
+   instead, sorting only the unique entities, so it numbers them exactly
+   as the default does. */
+void enable_hashed_matching(bool yn);
+bool is_hashed_matching_enabled();
+
+/* Adaptation picks independent sets of cavities in rounds, each of
+   which exchanges the undecided states with neighboring ranks.
+   An entity joins the set once its quality beats that of all its
+   undecided neighbors. By default ties are broken by global number,
+   so regions of equal quality are decided one global number after
+   the other, taking as many rounds as their longest chain.
+   The randomized variant breaks ties by a hash of the global number
+   and the round instead (Luby's algorithm), deciding such regions in
+   O(log n) rounds in expectation, and checks for global termination
+   once every two rounds. Its sets tend to be smaller. */
+struct IndsetStats {
+  std::size_t ncalls;
+  std::size_t nrounds;
+  std::size_t max_rounds;   // in a single call
+  std::size_t nreductions;  // global termination checks
+};
+void enable_randomized_indset(bool yn);
+bool is_randomized_indset_enabled();
+IndsetStats get_indset_stats();
+void reset_indset_stats();
+
 void classify_by_angles(Mesh* mesh, Real sharp_angle);
 
 Adj reflect_down(LOs hv2v, LOs lv2v, Adj v2l, Int high_dim, Int low_dim);
@@ -632,6 +904,7 @@ Read<I8> each_eq_to(Read<T> a, T b);
 template <typename T>
 Read<T> multiply_each_by(T factor, Read<T> a);
 LOs collect_marked(Read<I8> marks);
+LOs collect_marked(Bits marks);
 
 bool warp_to_limit(Mesh* mesh, AdaptOpts const& opts);
 bool approach_size_field(Mesh* mesh, AdaptOpts const& opts);
@@ -722,6 +995,10 @@ bool ends_with(std::string const& s, std::string const& suffix);
       Int ncomps, Int xfer, Int outflags, Read<T> array, bool internal);       \
   extern template void Mesh::set_tag(                                          \
       Int dim, std::string const& name, Read<T> array, bool internal);         \
+  extern template bool Mesh::has_tag(Int dim, TagHandle<T> tag) const;         \
+  extern template Read<T> Mesh::get_array(Int dim, TagHandle<T> tag) const;    \
+  extern template void Mesh::set_tag(                                          \
+      Int dim, TagHandle<T> tag, Read<T> array, bool internal);                \
   extern template Read<T> Mesh::sync_array(Int ent_dim, Read<T> a, Int width); \
   extern template Read<T> Mesh::owned_array(                                   \
       Int ent_dim, Read<T> a, Int width);                                      \
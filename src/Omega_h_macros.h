@@ -19,6 +19,7 @@
       OMEGA_H_VERSION_PATCH) "+" OMEGA_H_TOSTRING(defined(OMEGA_H_USE_MPI))    \
       OMEGA_H_TOSTRING(defined(OMEGA_H_USE_KOKKOS))                            \
           OMEGA_H_TOSTRING(defined(OMEGA_H_USE_OPENMP))                        \
+          OMEGA_H_TOSTRING(defined(OMEGA_H_USE_THREADS))                       \
               OMEGA_H_TOSTRING(defined(OMEGA_H_USE_CUDA))                      \
                   OMEGA_H_TOSTRING(defined(OMEGA_H_USE_ZLIB))                  \
                   OMEGA_H_TOSTRING(defined(OMEGA_H_USE_MESHB))                  \
@@ -1,10 +1,17 @@
+#include "adapt.hpp"
+
 #include <iomanip>
 #include <iostream>
 
 #include "array.hpp"
 #include "coarsen.hpp"
+#include "comm.hpp"
+#include "expr.hpp"
 #include "histogram.hpp"
+#include "indset.hpp"
+#include "map.hpp"
 #include "mark.hpp"
+#include "migrate.hpp"
 #include "quality.hpp"
 #include "refine.hpp"
 #include "simplices.hpp"
@@ -29,14 +36,21 @@ AdaptOpts::AdaptOpts(Mesh* mesh) {
   verbosity = EACH_REBUILD;
   length_histogram_min = 0.0;
   length_histogram_max = 3.0;
+  nregion_layers = 1;
+  max_passes = ArithTraits<Int>::max();
+  max_seconds = ArithTraits<Real>::max();
+  min_changed_fraction = 0.0;
+  max_predicted_imbalance = 2.0;
 }
 
 static void goal_stats(Mesh* mesh, char const* name, Int ent_dim, Reals values,
     Real floor, Real ceil, Real minval, Real maxval) {
-  auto low_marks = each_lt(values, floor);
-  auto high_marks = each_gt(values, ceil);
-  auto nlow = count_owned_marks(mesh, ent_dim, low_marks);
-  auto nhigh = count_owned_marks(mesh, ent_dim, high_marks);
+  auto comm = mesh->comm();
+  auto owned = mesh->owned(ent_dim);
+  auto nlow = comm->allreduce(
+      GO(sum(lazy(values) < floor && lazy(owned))), OMEGA_H_SUM);
+  auto nhigh = comm->allreduce(
+      GO(sum(lazy(values) > ceil && lazy(owned))), OMEGA_H_SUM);
   auto ntotal = mesh->nglobal_ents(ent_dim);
   auto nmid = ntotal - nlow - nhigh;
   if (mesh->comm()->rank() == 0) {
@@ -74,11 +88,38 @@ static void adapt_summary(Mesh* mesh, AdaptOpts const& opts, Real minqual,
       opts.max_length_desired, minlen, maxlen);
 }
 
+/* inside a region, the cached whole-mesh values are read when
+   they exist (transfer keeps them up to date), and otherwise only
+   the region's entities are measured */
+static Reals region_qualities(Mesh* mesh, AdaptOpts const& opts) {
+  if (!restricts_adapt_region(opts)) return mesh->ask_qualities();
+  auto elems = collect_marked(mark_adapt_region(mesh, opts, mesh->dim()));
+  if (!mesh->has_tag(mesh->dim(), "quality")) {
+    return measure_qualities(mesh, elems);
+  }
+  return unmap(elems, mesh->ask_qualities(), 1);
+}
+
+static Reals region_lengths(Mesh* mesh, AdaptOpts const& opts) {
+  if (!restricts_adapt_region(opts)) return mesh->ask_lengths();
+  auto edges = collect_marked(mark_adapt_region(mesh, opts, EDGE));
+  if (!mesh->has_tag(EDGE, "length")) return measure_edges_metric(mesh, edges);
+  return unmap(edges, mesh->ask_lengths(), 1);
+}
+
+static Real region_min_quality(Mesh* mesh, AdaptOpts const& opts) {
+  if (!restricts_adapt_region(opts)) return mesh->min_quality();
+  auto quals = region_qualities(mesh, opts);
+  return mesh->comm()->allreduce(min(quals), OMEGA_H_MIN);
+}
+
 static bool adapt_check(Mesh* mesh, AdaptOpts const& opts) {
+  auto quals = region_qualities(mesh, opts);
+  auto lengths = region_lengths(mesh, opts);
   Real minqual, maxqual;
-  get_minmax(mesh, mesh->ask_qualities(), &minqual, &maxqual);
+  get_minmax(mesh, quals, &minqual, &maxqual);
   Real minlen, maxlen;
-  get_minmax(mesh, mesh->ask_lengths(), &minlen, &maxlen);
+  get_minmax(mesh, lengths, &minlen, &maxlen);
   if (minqual >= opts.min_quality_desired &&
       minlen >= opts.min_length_desired && maxlen <= opts.max_length_desired) {
     if (opts.verbosity > SILENT && mesh->comm()->rank() == 0) {
@@ -93,13 +134,140 @@ static bool adapt_check(Mesh* mesh, AdaptOpts const& opts) {
   return false;
 }
 
-static void do_histograms(Mesh* mesh, AdaptOpts const& opts) {
-  auto qh =
-      get_histogram<10>(mesh, mesh->dim(), mesh->ask_qualities(), 0.0, 1.0);
-  print_histogram(mesh, qh, "quality");
-  auto lh = get_histogram<10>(mesh, VERT, mesh->ask_lengths(),
+static Histogram<nhistogram_buckets> get_quality_histogram(Mesh* mesh) {
+  return get_histogram<nhistogram_buckets>(
+      mesh, mesh->dim(), mesh->ask_qualities(), 0.0, 1.0);
+}
+
+static Histogram<nhistogram_buckets> get_length_histogram(
+    Mesh* mesh, AdaptOpts const& opts) {
+  return get_histogram<nhistogram_buckets>(mesh, EDGE, mesh->ask_lengths(),
       opts.length_histogram_min, opts.length_histogram_max);
-  print_histogram(mesh, lh, "length");
+}
+
+static void do_histograms(Mesh* mesh, AdaptOpts const& opts) {
+  print_histogram(mesh, get_quality_histogram(mesh), "quality");
+  print_histogram(mesh, get_length_histogram(mesh, opts), "length");
+}
+
+static AdaptHistogram to_adapt_histogram(Histogram<nhistogram_buckets> h) {
+  AdaptHistogram out;
+  out.min = h.min;
+  out.max = h.max;
+  for (Int i = 0; i < nhistogram_buckets; ++i) {
+    out.counts.push_back(h.counts[i]);
+  }
+  return out;
+}
+
+static AdaptPassStats* current_pass = nullptr;
+
+bool is_counting_adapt_keys() { return current_pass != nullptr; }
+
+void count_refined_keys(GO nkeys) {
+  if (current_pass) current_pass->nrefined += nkeys;
+}
+
+void count_collapsed_keys(GO nkeys) {
+  if (current_pass) current_pass->ncollapsed += nkeys;
+}
+
+void count_swapped_keys(GO nkeys) {
+  if (current_pass) current_pass->nswapped += nkeys;
+}
+
+typedef bool (*AdaptOperation)(Mesh* mesh, AdaptOpts const& opts);
+
+/* the state of one adapt() call, (stats) may be null */
+struct AdaptRun {
+  AdaptStats* stats;
+  Now t0;
+  Int npasses;
+  AdaptStop stop;
+};
+
+static AdaptPassStats record_pass(Mesh* mesh, AdaptOpts const& opts,
+    char const* name, AdaptOperation operation) {
+  AdaptPassStats pass;
+  pass.operation = name;
+  pass.nrefined = 0;
+  pass.ncollapsed = 0;
+  pass.nswapped = 0;
+  auto rounds_before = get_indset_stats().nrounds;
+  auto migrations_before = get_nmigrations();
+  auto bytes_before = get_exchanged_bytes();
+  auto t0 = now();
+  current_pass = &pass;
+  pass.modified = operation(mesh, opts);
+  current_pass = nullptr;
+  auto t1 = now();
+  pass.nindset_rounds = get_indset_stats().nrounds - rounds_before;
+  pass.nmigrations = get_nmigrations() - migrations_before;
+  pass.nbytes_moved = get_exchanged_bytes() - bytes_before;
+  pass.seconds = t1 - t0;
+  return pass;
+}
+
+static void spend_budgets(Mesh* mesh, AdaptOpts const& opts, AdaptRun* run,
+    AdaptPassStats const& pass, GO nedges, GO nverts) {
+  if (pass.modified && ++run->npasses >= opts.max_passes) {
+    run->stop = ADAPT_MAX_PASSES;
+    return;
+  }
+  if (opts.max_seconds < ArithTraits<Real>::max()) {
+    /* the slowest rank decides, so that all ranks stop together */
+    auto seconds = mesh->comm()->allreduce(now() - run->t0, OMEGA_H_MAX);
+    if (seconds >= opts.max_seconds) {
+      run->stop = ADAPT_MAX_SECONDS;
+      return;
+    }
+  }
+  if (pass.modified && opts.min_changed_fraction > 0.0) {
+    auto fraction = Real(pass.nrefined + pass.nswapped) / Real(nedges) +
+                    Real(pass.ncollapsed) / Real(nverts);
+    if (fraction < opts.min_changed_fraction) run->stop = ADAPT_FEW_CHANGES;
+  }
+}
+
+/* runs one operation unless a budget is spent, recording it
+   as a pass if there are stats to fill or changes to count */
+static bool run_pass(Mesh* mesh, AdaptOpts const& opts, AdaptRun* run,
+    char const* name, AdaptOperation operation) {
+  if (run->stop != ADAPT_DONE) return false;
+  if (run->npasses >= opts.max_passes) {
+    run->stop = ADAPT_MAX_PASSES;
+    return false;
+  }
+  auto counts_changes = (opts.min_changed_fraction > 0.0);
+  GO nedges = 0;
+  GO nverts = 0;
+  if (counts_changes) {
+    nedges = mesh->nglobal_ents(EDGE);
+    nverts = mesh->nglobal_ents(VERT);
+  }
+  AdaptPassStats pass;
+  if (run->stats || counts_changes) {
+    pass = record_pass(mesh, opts, name, operation);
+    if (run->stats) run->stats->passes.push_back(pass);
+  } else {
+    pass.modified = operation(mesh, opts);
+  }
+  spend_budgets(mesh, opts, run, pass, nedges, nverts);
+  return pass.modified;
+}
+
+static char const* describe_stop(AdaptStop stop) {
+  switch (stop) {
+    case ADAPT_DONE:
+      return "done";
+    case ADAPT_MAX_PASSES:
+      return "ran out of passes";
+    case ADAPT_MAX_SECONDS:
+      return "ran out of time";
+    case ADAPT_FEW_CHANGES:
+      return "last pass changed too little";
+  }
+  NORETURN("");
 }
 
 static void validate(Mesh* mesh, AdaptOpts const& opts) {
@@ -108,6 +276,12 @@ static void validate(Mesh* mesh, AdaptOpts const& opts) {
   CHECK(opts.min_quality_desired <= 1.0);
   CHECK(opts.nsliver_layers >= 0);
   CHECK(opts.nsliver_layers < 100);
+  CHECK(opts.region_class_dims.size() == opts.region_class_ids.size());
+  CHECK(opts.nregion_layers >= 0);
+  CHECK(opts.max_passes >= 0);
+  CHECK(opts.max_seconds >= 0.0);
+  CHECK(opts.min_changed_fraction >= 0.0);
+  CHECK(opts.max_predicted_imbalance >= 1.0);
   auto mq = mesh->min_quality();
   if (mq < opts.min_quality_allowed && !mesh->comm()->rank()) {
     std::cout << "WARNING: worst input element has quality " << mq
@@ -132,44 +306,99 @@ static void post_rebuild(Mesh* mesh, AdaptOpts const& opts) {
   if (opts.verbosity >= EACH_REBUILD) adapt_check(mesh, opts);
 }
 
-static void satisfy_lengths(Mesh* mesh, AdaptOpts const& opts) {
+static Real predict_imbalance(Mesh* mesh) {
+  Reals elems_per_elem;
+  if (mesh->has_tag(VERT, "size")) {
+    elems_per_elem =
+        expected_elems_per_elem_iso(mesh, mesh->get_array<Real>(VERT, "size"));
+  } else if (mesh->has_tag(VERT, "metric")) {
+    elems_per_elem = expected_elems_per_elem_metric(
+        mesh, mesh->get_array<Real>(VERT, "metric"));
+  } else {
+    return 1.0;
+  }
+  auto comm = mesh->comm();
+  auto load = sum(mesh->owned_array(mesh->dim(), elems_per_elem, 1));
+  auto max_load = comm->allreduce(load, OMEGA_H_MAX);
+  auto avg_load = comm->allreduce(load, OMEGA_H_SUM) / comm->size();
+  if (avg_load <= 0.0) return 1.0;
+  return max_load / avg_load;
+}
+
+/* balances by the expected output before refining, so that
+   refinement itself does not pile up on a few ranks */
+static void balance_for_output(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
+  if (mesh->comm()->size() == 1) return;
+  auto imbalance = predict_imbalance(mesh);
+  if (stats) stats->predicted_imbalance = imbalance;
+  if (imbalance <= opts.max_predicted_imbalance) return;
+  if ((opts.verbosity >= EACH_REBUILD) && !mesh->comm()->rank()) {
+    std::cout << "predicted imbalance " << imbalance << ", balancing\n";
+  }
+  mesh->balance(true);
+  if (stats) stats->balanced = true;
+}
+
+static void satisfy_lengths(
+    Mesh* mesh, AdaptOpts const& opts, AdaptRun* run) {
+  profile::Region region("satisfy_lengths");
   bool did_anything;
   do {
     did_anything = false;
-    if (refine_by_size(mesh, opts)) {
+    if (run_pass(mesh, opts, run, "refine", refine_by_size)) {
       post_rebuild(mesh, opts);
       did_anything = true;
     }
-    if (coarsen_by_size(mesh, opts)) {
+    if (run_pass(mesh, opts, run, "coarsen", coarsen_by_size)) {
       post_rebuild(mesh, opts);
       did_anything = true;
     }
-  } while (did_anything);
+  } while (did_anything && run->stop == ADAPT_DONE);
 }
 
-static void satisfy_quality(Mesh* mesh, AdaptOpts const& opts) {
-  if (mesh->min_quality() >= opts.min_quality_desired) return;
+static void satisfy_quality(
+    Mesh* mesh, AdaptOpts const& opts, AdaptRun* run) {
+  profile::Region region("satisfy_quality");
+  if (run->stop != ADAPT_DONE) return;
+  if (region_min_quality(mesh, opts) >= opts.min_quality_desired) return;
   if ((opts.verbosity >= EACH_REBUILD) && !mesh->comm()->rank()) {
     std::cout << "addressing element qualities\n";
   }
   do {
-    if (swap_edges(mesh, opts)) {
+    if (run_pass(mesh, opts, run, "swap", swap_edges)) {
       post_rebuild(mesh, opts);
       continue;
     }
-    if (coarsen_slivers(mesh, opts)) {
+    if (run_pass(mesh, opts, run, "coarsen_slivers", coarsen_slivers)) {
       post_rebuild(mesh, opts);
       continue;
     }
+    if (run->stop != ADAPT_DONE) break;
     if ((opts.verbosity > SILENT) && !mesh->comm()->rank()) {
       std::cout << "adapt() could not satisfy quality\n";
     }
     break;
-  } while (mesh->min_quality() < opts.min_quality_desired);
+  } while (run->stop == ADAPT_DONE &&
+           region_min_quality(mesh, opts) < opts.min_quality_desired);
 }
 
-static void post_adapt(
-    Mesh* mesh, AdaptOpts const& opts, Now t0, Now t1, Now t2, Now t3) {
+static void fill_stats(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats,
+    Now t0, Now t1, Now t2, Now t3, Now t4) {
+  stats->lengths_seconds = t2 - t1;
+  stats->quality_seconds = t3 - t2;
+  stats->total_seconds = t4 - t0;
+  stats->quality_histogram = to_adapt_histogram(get_quality_histogram(mesh));
+  stats->length_histogram =
+      to_adapt_histogram(get_length_histogram(mesh, opts));
+}
+
+static void post_adapt(Mesh* mesh, AdaptOpts const& opts, AdaptStop stop,
+    Now t0, Now t1, Now t2, Now t3) {
+  if (stop != ADAPT_DONE && opts.verbosity > SILENT &&
+      !mesh->comm()->rank()) {
+    std::cout << "adapt() stopped early: " << describe_stop(stop) << '\n';
+  }
   if (opts.verbosity == EACH_ADAPT) {
     if (!mesh->comm()->rank()) std::cout << "after adapting:\n";
     adapt_check(mesh, opts);
@@ -189,14 +418,40 @@ static void post_adapt(
 }
 
 bool adapt(Mesh* mesh, AdaptOpts const& opts) {
+  return adapt(mesh, opts, nullptr);
+}
+
+bool adapt(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
+  profile::Region region("adapt");
+  if (stats) stats->passes.clear();
   Now t0 = now();
-  if (!pre_adapt(mesh, opts)) return false;
+  AdaptRun run;
+  run.stats = stats;
+  run.t0 = t0;
+  run.npasses = 0;
+  run.stop = ADAPT_DONE;
+  if (stats) {
+    stats->stop = ADAPT_DONE;
+    stats->predicted_imbalance = 1.0;
+    stats->balanced = false;
+  }
+  /* the region marks of an earlier call may be for other options */
+  forget_adapt_region(mesh);
+  if (!pre_adapt(mesh, opts)) {
+    forget_adapt_region(mesh);
+    if (stats) fill_stats(mesh, opts, stats, t0, t0, t0, t0, now());
+    return false;
+  }
+  balance_for_output(mesh, opts, stats);
   Now t1 = now();
-  satisfy_lengths(mesh, opts);
+  satisfy_lengths(mesh, opts, &run);
   Now t2 = now();
-  satisfy_quality(mesh, opts);
+  satisfy_quality(mesh, opts, &run);
   Now t3 = now();
-  post_adapt(mesh, opts, t0, t1, t2, t3);
+  post_adapt(mesh, opts, run.stop, t0, t1, t2, t3);
+  forget_adapt_region(mesh);
+  if (stats) stats->stop = run.stop;
+  if (stats) fill_stats(mesh, opts, stats, t0, t1, t2, t3, now());
   return true;
 }
 
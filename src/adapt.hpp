@@ -0,0 +1,17 @@
+#ifndef ADAPT_HPP
+#define ADAPT_HPP
+
+#include "internal.hpp"
+
+namespace Omega_h {
+
+/* true while adapt() is filling an AdaptStats. rebuilds then
+   report their global key counts, even if they are not verbose */
+bool is_counting_adapt_keys();
+void count_refined_keys(GO nkeys);
+void count_collapsed_keys(GO nkeys);
+void count_swapped_keys(GO nkeys);
+
+}  // end namespace Omega_h
+
+#endif
@@ -5,7 +5,10 @@
 
 namespace Omega_h {
 
-LOs order_by_globals(LOs a2ab, LOs ab2b, Read<GO> b_global);
+/* sorts each upward list (and its codes) by the global numbers
+   of the high entities */
+void order_by_globals(
+    LOs l2lh, Write<LO> lh2h, Write<I8> codes, Read<GO> hg);
 
 Adj invert_adj(Adj down, Int nlows_per_high, LO nlows, Read<GO> high_globals);
 
@@ -45,6 +48,10 @@ void find_matches_ex(Int deg, LOs a2fv, Read<T> av2v, Read<T> bv2v, Adj v2b,
    adjacency */
 Adj reflect_down(LOs hv2v, LOs lv2v, LO nv, Int high_dim, Int low_dim);
 
+/* the same as above, but finds the low entities through a hash table
+   of their vertex lists instead of through upward adjacency */
+Adj reflect_down_by_hash(LOs hv2v, LOs lv2v, Int high_dim, Int low_dim);
+
 Adj transit(Adj h2m, Adj m2l, Int high_dim, Int low_dim);
 
 Graph verts_across_edges(Adj e2v, Adj v2e);
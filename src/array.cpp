@@ -1,43 +1,57 @@
 #include "array.hpp"
 
 #include "algebra.hpp"
+#include "expr.hpp"
 #include "loop.hpp"
+#include "memory.hpp"
+#include "pool.hpp"
 
 namespace Omega_h {
 
-static std::size_t current_array_bytes = 0;
-
-std::size_t get_current_bytes() { return current_array_bytes; }
-
-static std::size_t max_array_bytes = 0;
-
-std::size_t get_max_bytes() { return max_array_bytes; }
-
 #ifdef OMEGA_H_USE_KOKKOS
 template <typename T>
 Write<T>::Write(Kokkos::View<T*> view) : view_(view), exists_(true) {}
+#else
+/* the deleter runs exactly once per allocation, which makes it
+   the thread-safe place to return the memory and uncount it */
+template <typename T>
+struct PoolDeleter {
+  std::size_t bytes;
+  bool pooled;
+  Int label;
+  void operator()(T* p) const {
+    pool_free(p, bytes, pooled);
+    record_deallocation(label, bytes);
+  }
+};
+
+template <typename T>
+static std::shared_ptr<T> pool_alloc_array(LO size) {
+  PoolDeleter<T> deleter;
+  deleter.bytes = static_cast<std::size_t>(size) * sizeof(T);
+  deleter.label = current_memory_label();
+  auto p = static_cast<T*>(pool_alloc(deleter.bytes, &deleter.pooled));
+  record_allocation(deleter.label, deleter.bytes);
+  return std::shared_ptr<T>(p, deleter);
+}
 #endif
 
 template <typename T>
 Write<T>::Write(LO size)
     :
 #ifdef OMEGA_H_USE_KOKKOS
-      view_(Kokkos::ViewAllocateWithoutInitializing("omega_h"),
+      view_(Kokkos::ViewAllocateWithoutInitializing(
+                memory_label_name(current_memory_label())),
           static_cast<std::size_t>(size))
 #else
-      ptr_(new T[size], std::default_delete<T[]>()),
+      ptr_(pool_alloc_array<T>(size)),
       size_(size)
 #endif
       ,
       exists_(true) {
 #ifdef OMEGA_H_USE_KOKKOS
-  current_array_bytes += view_.span() * sizeof(T);
-#else
-  current_array_bytes += static_cast<std::size_t>(size) * sizeof(T);
+  record_allocation(current_memory_label(), view_.span() * sizeof(T));
 #endif
-  if (current_array_bytes > max_array_bytes) {
-    max_array_bytes = current_array_bytes;
-  }
 }
 
 template <typename T>
@@ -45,11 +59,8 @@ void Write<T>::dtor() {
 #ifdef OMEGA_H_USE_KOKKOS
   if (view_.use_count() == 1) {
     CHECK(view_.span() == view_.size());
-    current_array_bytes -= view_.span() * sizeof(T);
-  }
-#else
-  if (ptr_.unique()) {
-    current_array_bytes -= static_cast<std::size_t>(size_) * sizeof(T);
+    record_deallocation(
+        find_memory_label(view_.label()), view_.span() * sizeof(T));
   }
 #endif
 }
@@ -421,10 +432,7 @@ T HostRead<T>::last() const {
 
 template <typename T>
 Read<T> multiply_each_by(T factor, Read<T> a) {
-  Write<T> b(a.size());
-  auto f = LAMBDA(LO i) { b[i] = a[i] * factor; };
-  parallel_for(a.size(), f);
-  return b;
+  return eval(lazy(a) * factor);
 }
 
 template <typename T>
@@ -457,102 +465,60 @@ Read<T> divide_each(Read<T> a, Read<T> b) {
 
 template <typename T>
 Read<T> add_each(Read<T> a, Read<T> b) {
-  CHECK(a.size() == b.size());
-  Write<T> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = a[i] + b[i]; };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) + lazy(b));
 }
 
 template <typename T>
 Read<T> subtract_each(Read<T> a, Read<T> b) {
-  CHECK(a.size() == b.size());
-  Write<T> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = a[i] - b[i]; };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) - lazy(b));
 }
 
 template <typename T>
 Read<T> add_to_each(Read<T> a, T b) {
-  Write<T> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = a[i] + b; };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) + b);
 }
 
 template <typename T>
 Read<I8> each_geq_to(Read<T> a, T b) {
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] >= b); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) >= b);
 }
 
 template <typename T>
 Read<I8> each_gt(Read<T> a, T b) {
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] > b); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) > b);
 }
 
 template <typename T>
 Read<I8> each_lt(Read<T> a, T b) {
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] < b); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) < b);
 }
 
 template <typename T>
 Read<I8> gt_each(Read<T> a, Read<T> b) {
-  CHECK(a.size() == b.size());
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] > b[i]); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) > lazy(b));
 }
 
 template <typename T>
 Read<I8> geq_each(Read<T> a, Read<T> b) {
-  CHECK(a.size() == b.size());
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] >= b[i]); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) >= lazy(b));
 }
 
 template <typename T>
 Read<I8> each_neq_to(Read<T> a, T b) {
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] != b); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) != b);
 }
 
 template <typename T>
 Read<I8> each_eq_to(Read<T> a, T b) {
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] == b); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) == b);
 }
 
 Read<I8> land_each(Read<I8> a, Read<I8> b) {
-  CHECK(a.size() == b.size());
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] && b[i]); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) && lazy(b));
 }
 
 Read<I8> lor_each(Read<I8> a, Read<I8> b) {
-  CHECK(a.size() == b.size());
-  Write<I8> c(a.size());
-  auto f = LAMBDA(LO i) { c[i] = (a[i] || b[i]); };
-  parallel_for(c.size(), f);
-  return c;
+  return eval(lazy(a) || lazy(b));
 }
 
 template <typename T>
@@ -7,6 +7,8 @@ template <class T>
 INLINE void atomic_increment(volatile T* const dest) {
 #ifdef OMEGA_H_USE_KOKKOS
   return Kokkos::atomic_increment(dest);
+#elif defined(OMEGA_H_USE_THREADS)
+  __atomic_add_fetch(dest, 1, __ATOMIC_RELAXED);
 #else
   ++(*dest);
 #endif
@@ -16,6 +18,8 @@ template <class T>
 INLINE void atomic_add(volatile T* const dest, const T val) {
 #ifdef OMEGA_H_USE_KOKKOS
   return Kokkos::atomic_add(dest, val);
+#elif defined(OMEGA_H_USE_THREADS)
+  __atomic_add_fetch(dest, val, __ATOMIC_RELAXED);
 #else
   *dest += val;
 #endif
@@ -25,6 +29,8 @@ template <class T>
 INLINE T atomic_fetch_add(volatile T* const dest, const T val) {
 #ifdef OMEGA_H_USE_KOKKOS
   return Kokkos::atomic_fetch_add(dest, val);
+#elif defined(OMEGA_H_USE_THREADS)
+  return __atomic_fetch_add(dest, val, __ATOMIC_RELAXED);
 #else
   T tmp = *dest;
   *dest += val;
@@ -32,6 +38,34 @@ INLINE T atomic_fetch_add(volatile T* const dest, const T val) {
 #endif
 }
 
+/* returns the old value of (*dest), which was replaced by (val)
+   if it equaled (expected) */
+template <class T>
+INLINE T atomic_cas(volatile T* const dest, const T expected, const T val) {
+#ifdef OMEGA_H_USE_KOKKOS
+  return Kokkos::atomic_compare_exchange(dest, expected, val);
+#elif defined(OMEGA_H_USE_THREADS)
+  T old = expected;
+  __atomic_compare_exchange_n(
+      dest, &old, val, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+  return old;
+#else
+  T old = *dest;
+  if (old == expected) *dest = val;
+  return old;
+#endif
+}
+
+template <class T>
+INLINE void atomic_max(volatile T* const dest, const T val) {
+  T old = *dest;
+  while (old < val) {
+    T seen = atomic_cas(dest, old, val);
+    if (seen == old) break;
+    old = seen;
+  }
+}
+
 }  // end namespace Omega_h
 
 #endif
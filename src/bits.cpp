@@ -0,0 +1,38 @@
+#include "bits.hpp"
+
+#include "loop.hpp"
+
+namespace Omega_h {
+
+Bits::Bits(LO size, Read<I32> words) : size_(size), words_(words) {
+  CHECK(words.size() == nwords());
+}
+
+Bits::Bits(Read<I8> marks) : Bits(pack_bits(lazy(marks) != I8(0))) {}
+
+Read<I8> Bits::unpack() const { return eval(lazy(*this)); }
+
+struct CountBits : public SumFunctor<LO> {
+  using value_type = I64;
+  Read<I32> words_;
+  CountBits(Read<I32> words) : words_(words) {}
+  DEVICE void operator()(LO w, value_type& update) const {
+    update += popcount(static_cast<std::uint32_t>(words_[w]));
+  }
+};
+
+LO count_bits(Bits a) {
+  return static_cast<LO>(parallel_reduce(a.nwords(), CountBits(a.words())));
+}
+
+Bits land_bits(Bits a, Bits b) {
+  CHECK(a.size() == b.size());
+  return Bits(a.size(), eval(lazy(a.words()) & lazy(b.words())));
+}
+
+Bits lor_bits(Bits a, Bits b) {
+  CHECK(a.size() == b.size());
+  return Bits(a.size(), eval(lazy(a.words()) | lazy(b.words())));
+}
+
+}  // end namespace Omega_h
@@ -0,0 +1,68 @@
+#ifndef BITS_HPP
+#define BITS_HPP
+
+#include <cstdint>
+
+#include "expr.hpp"
+
+namespace Omega_h {
+
+INLINE Int popcount(std::uint32_t x) {
+#ifdef __CUDA_ARCH__
+  return __popc(x);
+#else
+  return __builtin_popcount(x);
+#endif
+}
+
+/* (x) must not be zero */
+INLINE Int count_trailing_zeros(std::uint32_t x) {
+#ifdef __CUDA_ARCH__
+  return __ffs(static_cast<int>(x)) - 1;
+#else
+  return __builtin_ctz(x);
+#endif
+}
+
+/* packs the values of a lazy expression (see expr.hpp)
+   straight into bits, without storing them as bytes first */
+template <typename E>
+Bits pack_bits(expr::Expr<E> const& e) {
+  auto n = e.size();
+  CHECK(n >= 0);
+  Write<I32> words((n + 31) / 32);
+  auto f = LAMBDA(LO w) {
+    std::uint32_t word = 0;
+    auto nbits = min2<LO>(32, n - w * 32);
+    for (Int b = 0; b < nbits; ++b) {
+      if (e(w * 32 + b)) word |= (std::uint32_t(1) << b);
+    }
+    words[w] = static_cast<I32>(word);
+  };
+  parallel_for(words.size(), f);
+  return Bits(n, words);
+}
+
+LO count_bits(Bits a);
+Bits land_bits(Bits a, Bits b);
+Bits lor_bits(Bits a, Bits b);
+
+namespace expr {
+
+struct BitsLeaf {
+  typedef I8 value_type;
+  Bits a_;
+  BitsLeaf(Bits a) : a_(a) {}
+  LO size() const { return a_.size(); }
+  DEVICE I8 operator()(LO i) const { return a_[i]; }
+};
+
+inline Expr<BitsLeaf> lazy(Bits a) { return BitsLeaf(a); }
+
+}  // end namespace expr
+
+using expr::lazy;
+
+}  // end namespace Omega_h
+
+#endif
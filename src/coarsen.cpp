@@ -2,8 +2,10 @@
 
 #include <iostream>
 
+#include "adapt.hpp"
 #include "array.hpp"
 #include "collapse.hpp"
+#include "expr.hpp"
 #include "indset.hpp"
 #include "loop.hpp"
 #include "map.hpp"
@@ -55,6 +57,7 @@ enum Improve { DONT_IMPROVE, IMPROVE_LOCALLY };
 
 static bool coarsen_ghosted(
     Mesh* mesh, AdaptOpts const& opts, Overshoot overshoot, Improve improve) {
+  profile::Region region("coarsen_ghosted");
   auto comm = mesh->comm();
   auto edge_cand_codes = get_edge_codes(mesh);
   auto edges_are_cands = each_neq_to(edge_cand_codes, I8(DONT_COLLAPSE));
@@ -115,6 +118,7 @@ static bool coarsen_ghosted(
 }
 
 static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("coarsen_element_based");
   auto comm = mesh->comm();
   auto verts_are_keys = mesh->get_array<I8>(VERT, "key");
   auto vert_quals = mesh->get_array<Real>(VERT, "collapse_quality");
@@ -122,9 +126,10 @@ static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
   mesh->remove_tag(VERT, "collapse_rail");
   auto keys2verts = collect_marked(verts_are_keys);
   auto nkeys = keys2verts.size();
-  if (opts.verbosity >= EACH_REBUILD) {
+  if (opts.verbosity >= EACH_REBUILD || is_counting_adapt_keys()) {
     auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
-    if (comm->rank() == 0) {
+    count_collapsed_keys(ntotal_keys);
+    if (opts.verbosity >= EACH_REBUILD && comm->rank() == 0) {
       std::cout << "coarsening " << ntotal_keys << " vertices\n";
     }
   }
@@ -138,6 +143,7 @@ static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
   auto same_verts2new_verts = LOs();
   auto old_verts2new_verts = LOs();
   auto old_lows2new_lows = LOs();
+  HostFew<LOs, 4> old_ents2new_ents_of_dim;
   for (Int ent_dim = 0; ent_dim <= mesh->dim(); ++ent_dim) {
     auto keys2prods = LOs();
     auto prod_verts2verts = LOs();
@@ -158,6 +164,9 @@ static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
     modify_ents(mesh, &new_mesh, ent_dim, VERT, keys2verts, keys2prods,
         prod_verts2verts, old_lows2new_lows, &prods2new_ents,
         &same_ents2old_ents, &same_ents2new_ents, &old_ents2new_ents);
+    old_ents2new_ents_of_dim[ent_dim] = old_ents2new_ents;
+    modify_up_adjs(
+        mesh, &new_mesh, ent_dim, old_ents2new_ents_of_dim, prods2new_ents);
     if (ent_dim == VERT) {
       old_verts2new_verts = old_ents2new_ents;
       if (has_xfer(mesh, VERT, OMEGA_H_MOMENTUM_VELOCITY)) {
@@ -212,19 +221,26 @@ static bool coarsen_ents(Mesh* mesh, AdaptOpts const& opts, Int ent_dim,
 }
 
 bool coarsen_by_size(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("coarsen");
+  ScopedMemoryLabel label("coarsen");
   auto comm = mesh->comm();
   auto lengths = mesh->ask_lengths();
-  auto edge_is_cand = each_lt(lengths, opts.min_length_desired);
-  if (comm->allreduce(max(edge_is_cand), OMEGA_H_MAX) != 1) return false;
+  auto edges_are_cands = restrict_to_adapt_region(
+      mesh, opts, EDGE, eval(lazy(lengths) < opts.min_length_desired));
+  if (comm->allreduce(max(edges_are_cands), OMEGA_H_MAX) != 1) return false;
   return coarsen_ents(
-      mesh, opts, EDGE, edge_is_cand, DONT_OVERSHOOT, DONT_IMPROVE);
+      mesh, opts, EDGE, edges_are_cands, DONT_OVERSHOOT, DONT_IMPROVE);
 }
 
 bool coarsen_slivers(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("coarsen_slivers");
+  ScopedMemoryLabel label("coarsen");
   mesh->set_parting(OMEGA_H_GHOSTED);
   auto comm = mesh->comm();
   auto elems_are_cands =
       mark_sliver_layers(mesh, opts.min_quality_desired, opts.nsliver_layers);
+  elems_are_cands =
+      restrict_to_adapt_region(mesh, opts, mesh->dim(), elems_are_cands);
   CHECK(comm->allreduce(max(elems_are_cands), OMEGA_H_MAX) == 1);
   return coarsen_ents(mesh, opts, mesh->dim(), elems_are_cands, ALLOW_OVERSHOOT,
       IMPROVE_LOCALLY);
@@ -57,6 +57,9 @@ struct MpiTraits<unsigned long> {
 
 static_assert(sizeof(int) == 4, "Comm assumes 32-bit int");
 
+/* total bytes this rank has sent to other ranks through Dist::exch() */
+std::size_t get_exchanged_bytes();
+
 #ifdef OMEGA_H_USE_MPI
 inline MPI_Op mpi_op(Omega_h_Op op) {
   switch (op) {
@@ -29,8 +29,13 @@ void add_ents2verts(Mesh* mesh, Int edim, LOs ev2v, Read<GO> vert_globals) {
   } else {
     auto ldim = edim - 1;
     auto lv2v = mesh->ask_verts_of(ldim);
-    auto v2l = mesh->ask_up(VERT, ldim);
-    auto down = reflect_down(ev2v, lv2v, v2l, edim, ldim);
+    Adj down;
+    if (is_hashed_matching_enabled()) {
+      down = reflect_down_by_hash(ev2v, lv2v, edim, ldim);
+    } else {
+      auto v2l = mesh->ask_up(VERT, ldim);
+      down = reflect_down(ev2v, lv2v, v2l, edim, ldim);
+    }
     mesh->set_ents(edim, down);
   }
   if (comm->size() > 1) {
@@ -1,6 +1,7 @@
 #include "comm.hpp"
 #include "internal.hpp"
 #include "protect.hpp"
+#include "threads.hpp"
 
 #include <cstdarg>
 #include <sstream>
@@ -40,6 +41,9 @@ extern "C" void Omega_h_init_internal(
     Kokkos::initialize(*argc, *argv);
     we_called_kokkos_init = true;
   }
+#endif
+#ifdef OMEGA_H_USE_THREADS
+  threads::init(0);
 #endif
   (void)argc;
   (void)argv;
@@ -49,12 +53,16 @@ extern "C" void Omega_h_init_internal(
 }
 
 extern "C" void Omega_h_finalize(void) {
+#ifdef OMEGA_H_USE_THREADS
+  threads::finalize();
+#endif
 #ifdef OMEGA_H_USE_KOKKOS
   if (we_called_kokkos_init) {
     Kokkos::finalize();
     we_called_kokkos_init = false;
   }
 #endif
+  enable_pooling(false);
   std::size_t mem_used = Omega_h::get_max_bytes();
   std::size_t max_mem_used = mem_used;
 #ifdef OMEGA_H_USE_MPI
@@ -64,7 +72,7 @@ extern "C" void Omega_h_finalize(void) {
   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   if (rank == 0) {
 #endif
-    printf("maximum Omega_h memory usage: %zu bytes\n", mem_used);
+    printf("maximum Omega_h memory usage: %zu bytes\n", max_mem_used);
 #ifdef OMEGA_H_USE_MPI
   }
 #endif
@@ -1,6 +1,8 @@
 #include "internal.hpp"
 
 #include "array.hpp"
+#include "bits.hpp"
+#include "comm.hpp"
 #include "loop.hpp"
 #include "map.hpp"
 #include "scan.hpp"
@@ -8,6 +10,22 @@
 
 namespace Omega_h {
 
+static std::size_t nexchanged_bytes = 0;
+
+std::size_t get_exchanged_bytes() { return nexchanged_bytes; }
+
+static void count_exchanged_bytes(
+    CommPtr comm, LOs sendcounts, std::size_t value_size) {
+  if (comm->size() == 1) return;
+  auto msgs2ranks = HostRead<I32>(comm->destinations());
+  auto msgs2counts = HostRead<LO>(sendcounts);
+  auto rank = comm->rank();
+  for (LO msg = 0; msg < msgs2ranks.size(); ++msg) {
+    if (msgs2ranks[msg] == rank) continue;
+    nexchanged_bytes += std::size_t(msgs2counts[msg]) * value_size;
+  }
+}
+
 Dist::Dist() {}
 
 Dist::Dist(Dist const& other) { copy(other); }
@@ -60,6 +78,10 @@ void Dist::set_dest_ranks(Read<I32> items2ranks) {
   auto fdegrees = get_degrees(msgs2content_[F]);
   auto rdegrees = comm_[F]->alltoall(fdegrees);
   msgs2content_[R] = offset_scan(rdegrees);
+  for (Int i = 0; i < 2; ++i) {
+    set_msgs_layout(i);
+    set_content2roots(i);
+  }
 }
 
 void Dist::set_dest_idxs(LOs fitems2rroots, LO nrroots) {
@@ -67,10 +89,43 @@ void Dist::set_dest_idxs(LOs fitems2rroots, LO nrroots) {
   auto rroots2rcontent = invert_map_by_sorting(rcontent2rroots, nrroots);
   roots2items_[R] = rroots2rcontent.a2ab;
   items2content_[R] = rroots2rcontent.ab2b;
+  set_content2roots(R);
 }
 
 void Dist::set_roots2items(LOs froots2fitems) {
   roots2items_[F] = froots2fitems;
+  set_content2roots(F);
+}
+
+/* packed marks travel as whole words per message: message (m) is sent
+   as words [msgs2words[m], msgs2words[m + 1]), its content entry (c)
+   being bit (c - msgs2content[m]) counted from the first of those */
+static LOs get_msgs2words(LOs msgs2content) {
+  auto nmsgs = msgs2content.size() - 1;
+  Write<LO> nwords(nmsgs);
+  auto f = LAMBDA(LO m) {
+    nwords[m] = (msgs2content[m + 1] - msgs2content[m] + 31) / 32;
+  };
+  parallel_for(nmsgs, f);
+  return offset_scan(LOs(nwords));
+}
+
+void Dist::set_msgs_layout(Int i) {
+  msgs2words_[i] = get_msgs2words(msgs2content_[i]);
+  words2msgs_[i] = invert_fan(msgs2words_[i]);
+  content2msgs_[i] = invert_fan(msgs2content_[i]);
+}
+
+/* the root whose mark goes into each content entry */
+void Dist::set_content2roots(Int i) {
+  auto content2roots = LOs(msgs2content_[i].last(), 0, 1);
+  if (items2content_[i].exists()) {
+    content2roots = invert_permutation(items2content_[i]);
+  }
+  if (roots2items_[i].exists()) {
+    content2roots = unmap(content2roots, invert_fan(roots2items_[i]), 1);
+  }
+  content2roots_[i] = content2roots;
 }
 
 Dist Dist::invert() const {
@@ -81,12 +136,17 @@ Dist Dist::invert() const {
     out.items2content_[i] = items2content_[1 - i];
     out.msgs2content_[i] = msgs2content_[1 - i];
     out.comm_[i] = comm_[1 - i];
+    out.msgs2words_[i] = msgs2words_[1 - i];
+    out.words2msgs_[i] = words2msgs_[1 - i];
+    out.content2msgs_[i] = content2msgs_[1 - i];
+    out.content2roots_[i] = content2roots_[1 - i];
   }
   return out;
 }
 
 template <typename T>
 Read<T> Dist::exch(Read<T> data, Int width) const {
+  profile::Region region("Dist::exch");
   if (roots2items_[F].exists()) {
     data = expand(data, roots2items_[F], width);
   }
@@ -97,6 +157,7 @@ Read<T> Dist::exch(Read<T> data, Int width) const {
   auto recvcounts = multiply_each_by(width, get_degrees(msgs2content_[R]));
   auto sdispls = offset_scan(sendcounts);
   auto rdispls = offset_scan(recvcounts);
+  count_exchanged_bytes(comm_[F], sendcounts, sizeof(T));
   data = comm_[F]->alltoallv(data, sendcounts, sdispls, recvcounts, rdispls);
   if (items2content_[R].exists()) {
     data = unmap(items2content_[R], data, width);
@@ -116,7 +177,7 @@ CommPtr Dist::comm() const { return comm_[F]; }
 
 LOs Dist::msgs2content() const { return msgs2content_[F]; }
 
-LOs Dist::content2msgs() const { return invert_fan(msgs2content_[F]); }
+LOs Dist::content2msgs() const { return content2msgs_[F]; }
 
 LOs Dist::items2msgs() const {
   return unmap(items2content_[F], content2msgs(), 1);
@@ -171,6 +232,52 @@ Remotes Dist::exch(Remotes data, Int width) const {
   return Remotes(ranks, idxs);
 }
 
+Bits Dist::exch(Bits data) const {
+  profile::Region region("Dist::exch");
+  auto content2roots = content2roots_[F];
+  auto smsgs2content = msgs2content_[F];
+  auto smsgs2words = msgs2words_[F];
+  auto swords2msgs = words2msgs_[F];
+  Write<I32> sendbuf(smsgs2words.last());
+  auto pack = LAMBDA(LO w) {
+    auto m = swords2msgs[w];
+    auto begin = smsgs2content[m] + (w - smsgs2words[m]) * 32;
+    auto nbits = min2<LO>(32, smsgs2content[m + 1] - begin);
+    std::uint32_t word = 0;
+    for (Int b = 0; b < nbits; ++b) {
+      if (data[content2roots[begin + b]]) word |= (std::uint32_t(1) << b);
+    }
+    sendbuf[w] = static_cast<I32>(word);
+  };
+  parallel_for(sendbuf.size(), pack);
+  auto rmsgs2content = msgs2content_[R];
+  auto rmsgs2words = msgs2words_[R];
+  auto swords_per_msg = get_degrees(smsgs2words);
+  count_exchanged_bytes(comm_[F], swords_per_msg, sizeof(I32));
+  auto recvbuf = comm_[F]->alltoallv(Read<I32>(sendbuf), swords_per_msg,
+      smsgs2words, get_degrees(rmsgs2words), rmsgs2words);
+  auto rcontent2msgs = content2msgs_[R];
+  auto items2rcontent = items2content_[R];
+  auto is_permuted = items2rcontent.exists();
+  auto nitems = is_permuted ? items2rcontent.size() : rmsgs2content.last();
+  Write<I32> out((nitems + 31) / 32);
+  auto unpack = LAMBDA(LO w) {
+    auto nbits = min2<LO>(32, nitems - w * 32);
+    std::uint32_t word = 0;
+    for (Int b = 0; b < nbits; ++b) {
+      auto i = w * 32 + b;
+      auto c = is_permuted ? items2rcontent[i] : i;
+      auto m = rcontent2msgs[c];
+      auto bit = rmsgs2words[m] * 32 + (c - rmsgs2content[m]);
+      auto rword = static_cast<std::uint32_t>(recvbuf[bit / 32]);
+      if ((rword >> (bit % 32)) & 1) word |= (std::uint32_t(1) << b);
+    }
+    out[w] = static_cast<I32>(word);
+  };
+  parallel_for(out.size(), unpack);
+  return Bits(nitems, out);
+}
+
 void Dist::copy(Dist const& other) {
   parent_comm_ = other.parent_comm_;
   for (Int i = 0; i < 2; ++i) {
@@ -178,6 +285,10 @@ void Dist::copy(Dist const& other) {
     items2content_[i] = other.items2content_[i];
     msgs2content_[i] = other.msgs2content_[i];
     comm_[i] = other.comm_[i];
+    msgs2words_[i] = other.msgs2words_[i];
+    words2msgs_[i] = other.words2msgs_[i];
+    content2msgs_[i] = other.content2msgs_[i];
+    content2roots_[i] = other.content2roots_[i];
   }
 }
 
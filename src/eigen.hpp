@@ -30,20 +30,22 @@ INLINE void characteristic_quadratic(Matrix<2, 2> A, Real& a, Real& b) {
    take the largest cross product of any pair of columns */
 INLINE Vector<3> single_eigenvector(Matrix<3, 3> m, Real l) {
   subtract_from_diag(m, l);
+  /* compare squared norms, only the winner needs a square root */
   auto v = cross(m[0], m[1]);
-  Real v_norm = norm(v);
+  Real v_norm_sq = norm_squared(v);
   Vector<3> c = cross(m[1], m[2]);
-  Real c_norm = norm(c);
-  if (c_norm > v_norm) {
+  Real c_norm_sq = norm_squared(c);
+  if (c_norm_sq > v_norm_sq) {
     v = c;
-    v_norm = c_norm;
+    v_norm_sq = c_norm_sq;
   }
   c = cross(m[0], m[2]);
-  c_norm = norm(c);
-  if (c_norm > v_norm) {
+  c_norm_sq = norm_squared(c);
+  if (c_norm_sq > v_norm_sq) {
     v = c;
-    v_norm = c_norm;
+    v_norm_sq = c_norm_sq;
   }
+  Real v_norm = sqrt(v_norm_sq);
   CHECK(v_norm > EPSILON);
   v = v / v_norm;
   return v;
@@ -167,6 +169,100 @@ INLINE Decomposition<dim> decompose_eigen(Matrix<dim, dim> m) {
   return {decomp.q, decomp.l * nm};
 }
 
+/* a closed-form decomposition for symmetric matrices,
+   which is what metric tensors and Hessians are.
+   the general path above forms the characteristic cubic
+   with a full matrix product and solves it with cube roots,
+   this one uses only the six unique entries and the
+   trigonometric solution:
+
+   O.K. Smith, "Eigenvalues of a symmetric 3x3 matrix",
+   Communications of the ACM 4(4):168, 1961.
+
+   the eigenvectors of a symmetric matrix are orthonormal,
+   so the third one is just the cross product of the other two.
+   the output order follows decompose_eigen_dim() above:
+   distinct roots come out as (largest, smallest, middle),
+   and a simple root goes first when the other is repeated. */
+INLINE Decomposition<3> decompose_symm_dim(Matrix<3, 3> m) {
+  Real const eps = 1e-6; /* same tolerance as solve_cubic() */
+  Real q = (m[0][0] + m[1][1] + m[2][2]) / 3.;
+  Real b00 = m[0][0] - q;
+  Real b11 = m[1][1] - q;
+  Real b22 = m[2][2] - q;
+  Real b01 = m[1][0];
+  Real b02 = m[2][0];
+  Real b12 = m[2][1];
+  Real p1 = square(b01) + square(b02) + square(b12);
+  Real p = sqrt((square(b00) + square(b11) + square(b22) + 2. * p1) / 6.);
+  Matrix<3, 3> out_q;
+  Vector<3> l;
+  /* the extreme roots are at most (2 sqrt(3) p) apart,
+     so all three are within (eps) of each other */
+  if (p < eps / 4.) {
+    l[0] = l[1] = l[2] = q;
+    return {identity_matrix<3, 3>(), l};
+  }
+  Real det_b = b00 * (b11 * b22 - square(b12)) -
+               b01 * (b01 * b22 - b12 * b02) + b02 * (b01 * b12 - b11 * b02);
+  Real r = max2(-1., min2(1., det_b / (2. * cube(p))));
+  Real phi = acos(r) / 3.;
+  Real l_max = q + 2. * p * cos(phi);
+  Real l_min = q + 2. * p * cos(phi + (2. * PI / 3.));
+  Real l_mid = 3. * q - l_max - l_min;
+  bool top_repeats = (l_max - l_mid) < eps;
+  bool bottom_repeats = (l_mid - l_min) < eps;
+  if (top_repeats && bottom_repeats) {
+    l[0] = l[1] = l[2] = q;
+    return {identity_matrix<3, 3>(), l};
+  }
+  if (top_repeats || bottom_repeats) {
+    l[0] = top_repeats ? l_min : l_max;
+    l[1] = l[2] = top_repeats ? average(l_max, l_mid) : average(l_mid, l_min);
+    auto b = form_ortho_basis(single_eigenvector(m, l[0]));
+    return {b, l};
+  }
+  l[0] = l_max;
+  l[1] = l_min;
+  l[2] = l_mid;
+  out_q[0] = single_eigenvector(m, l[0]);
+  out_q[1] = single_eigenvector(m, l[1]);
+  out_q[2] = cross(out_q[0], out_q[1]);
+  return {out_q, l};
+}
+
+INLINE Decomposition<2> decompose_symm_dim(Matrix<2, 2> m) {
+  Real mean = average(m[0][0], m[1][1]);
+  Real radius = sqrt(square((m[0][0] - m[1][1]) / 2.) + square(m[1][0]));
+  Vector<2> l;
+  /* see solve_quadratic(), the discriminant is (2 * radius)^2 */
+  if (square(2. * radius) < 1e-6) {
+    l[0] = l[1] = mean;
+    return {identity_matrix<2, 2>(), l};
+  }
+  l[0] = mean + radius;
+  l[1] = mean - radius;
+  Matrix<2, 2> q;
+  q[0] = single_eigenvector(m, l[0]);
+  q[1] = perp(q[0]);
+  return {q, l};
+}
+
+/* decompose a symmetric m x m matrix (where m <= 3).
+   only the lower triangle is read, and the output
+   (q) is orthonormal, so compose_ortho() rebuilds (m). */
+template <Int dim>
+INLINE Decomposition<dim> decompose_symm(Matrix<dim, dim> m) {
+  /* normalized for the same reason as decompose_eigen() */
+  Real nm = max_norm(m);
+  if (nm <= EPSILON) {
+    return {identity_matrix<dim, dim>(), zero_vector<dim>()};
+  }
+  m = m / nm;
+  auto decomp = decompose_symm_dim(m);
+  return {decomp.q, decomp.l * nm};
+}
+
 /* Q, again, being the matrix whose columns
    are the right eigenvectors, *not* the
    change of basis matrix */
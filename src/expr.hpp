@@ -0,0 +1,183 @@
+#ifndef EXPR_HPP
+#define EXPR_HPP
+
+#include "Omega_h_functors.hpp"
+#include "internal.hpp"
+#include "loop.hpp"
+
+namespace Omega_h {
+
+/* Lazy elementwise array expressions.
+
+   lazy(a) wraps a Read<T> in an expression, and the usual
+   operators combine expressions (and scalars) into larger ones
+   without touching memory. Nothing is computed until the
+   expression is consumed, by one of:
+
+     eval(e)        one parallel_for into a new array
+     sum(e), min(e), max(e)
+                    one parallel_reduce, no array at all
+
+   so that, for example,
+
+     sum(lazy(x) >= floor && lazy(x) < ceil)
+
+   counts the entries in [floor, ceil) in a single pass over (x)
+   where each_geq_to(), each_lt(), land_each() and sum() would make
+   three passes and allocate three temporary arrays.
+   Comparisons and logical operators give I8 (0 or 1) values,
+   arithmetic and bitwise operators give the type of their operands. */
+
+namespace expr {
+
+template <typename T>
+struct Leaf {
+  typedef T value_type;
+  Read<T> a_;
+  Leaf(Read<T> a) : a_(a) {}
+  LO size() const { return a_.size(); }
+  DEVICE T operator()(LO i) const { return a_[i]; }
+};
+
+/* a scalar fits arrays of any size, which is denoted by (-1) */
+template <typename T>
+struct Scalar {
+  typedef T value_type;
+  T value_;
+  Scalar(T value) : value_(value) {}
+  LO size() const { return -1; }
+  DEVICE T operator()(LO) const { return value_; }
+};
+
+template <typename Op, typename A, typename B>
+struct Binary {
+  typedef typename Op::template result<typename A::value_type>::type value_type;
+  A a_;
+  B b_;
+  Binary(A const& a, B const& b) : a_(a), b_(b) {
+    CHECK(a.size() == -1 || b.size() == -1 || a.size() == b.size());
+  }
+  LO size() const { return (a_.size() == -1) ? b_.size() : a_.size(); }
+  DEVICE value_type operator()(LO i) const { return Op::apply(a_(i), b_(i)); }
+};
+
+/* the wrapper that the operators below are overloaded on */
+template <typename E>
+struct Expr {
+  typedef typename E::value_type value_type;
+  E e_;
+  Expr(E const& e) : e_(e) {}
+  LO size() const { return e_.size(); }
+  DEVICE value_type operator()(LO i) const { return e_(i); }
+};
+
+#define OMEGA_H_EXPR_OP(Name, op, Result)                                      \
+  struct Name {                                                                \
+    template <typename T>                                                      \
+    struct result {                                                            \
+      typedef Result type;                                                     \
+    };                                                                         \
+    template <typename T>                                                      \
+    INLINE static Result apply(T a, T b) {                                     \
+      return static_cast<Result>(a op b);                                      \
+    }                                                                          \
+  };                                                                           \
+  template <typename A, typename B>                                            \
+  Expr<Binary<Name, A, B>> operator op(Expr<A> const& a, Expr<B> const& b) {   \
+    return Binary<Name, A, B>(a.e_, b.e_);                                     \
+  }                                                                            \
+  template <typename A>                                                        \
+  Expr<Binary<Name, A, Scalar<typename A::value_type>>> operator op(           \
+      Expr<A> const& a, typename A::value_type b) {                            \
+    typedef Scalar<typename A::value_type> S;                                  \
+    return Binary<Name, A, S>(a.e_, S(b));                                     \
+  }
+
+OMEGA_H_EXPR_OP(Less, <, I8)
+OMEGA_H_EXPR_OP(LessEqual, <=, I8)
+OMEGA_H_EXPR_OP(Greater, >, I8)
+OMEGA_H_EXPR_OP(GreaterEqual, >=, I8)
+OMEGA_H_EXPR_OP(Equal, ==, I8)
+OMEGA_H_EXPR_OP(NotEqual, !=, I8)
+OMEGA_H_EXPR_OP(And, &&, I8)
+OMEGA_H_EXPR_OP(Or, ||, I8)
+OMEGA_H_EXPR_OP(Plus, +, T)
+OMEGA_H_EXPR_OP(Minus, -, T)
+OMEGA_H_EXPR_OP(Times, *, T)
+OMEGA_H_EXPR_OP(Divide, /, T)
+OMEGA_H_EXPR_OP(BitAnd, &, T)
+OMEGA_H_EXPR_OP(BitOr, |, T)
+
+#undef OMEGA_H_EXPR_OP
+
+template <typename T>
+Expr<Leaf<T>> lazy(Read<T> a) {
+  return Leaf<T>(a);
+}
+
+template <typename E>
+Read<typename E::value_type> eval(Expr<E> const& e) {
+  CHECK(e.size() >= 0);
+  Write<typename E::value_type> out(e.size());
+  auto f = LAMBDA(LO i) { out[i] = e(i); };
+  parallel_for(out.size(), f);
+  return out;
+}
+
+template <typename E>
+struct SumExpr : public SumFunctor<typename E::value_type> {
+  using typename SumFunctor<typename E::value_type>::value_type;
+  Expr<E> e_;
+  SumExpr(Expr<E> const& e) : e_(e) {}
+  DEVICE void operator()(LO i, value_type& update) const {
+    update = update + e_(i);
+  }
+};
+
+template <typename E>
+struct MinExpr : public MinFunctor<typename E::value_type> {
+  using typename MinFunctor<typename E::value_type>::value_type;
+  Expr<E> e_;
+  MinExpr(Expr<E> const& e) : e_(e) {}
+  DEVICE void operator()(LO i, value_type& update) const {
+    update = min2<value_type>(update, e_(i));
+  }
+};
+
+template <typename E>
+struct MaxExpr : public MaxFunctor<typename E::value_type> {
+  using typename MaxFunctor<typename E::value_type>::value_type;
+  Expr<E> e_;
+  MaxExpr(Expr<E> const& e) : e_(e) {}
+  DEVICE void operator()(LO i, value_type& update) const {
+    update = max2<value_type>(update, e_(i));
+  }
+};
+
+template <typename E>
+typename StandinTraits<typename E::value_type>::type sum(Expr<E> const& e) {
+  CHECK(e.size() >= 0);
+  return parallel_reduce(e.size(), SumExpr<E>(e));
+}
+
+template <typename E>
+typename E::value_type min(Expr<E> const& e) {
+  CHECK(e.size() >= 0);
+  auto r = parallel_reduce(e.size(), MinExpr<E>(e));
+  return static_cast<typename E::value_type>(r);  // see StandinTraits
+}
+
+template <typename E>
+typename E::value_type max(Expr<E> const& e) {
+  CHECK(e.size() >= 0);
+  auto r = parallel_reduce(e.size(), MaxExpr<E>(e));
+  return static_cast<typename E::value_type>(r);  // see StandinTraits
+}
+
+}  // end namespace expr
+
+using expr::lazy;
+
+}  // end namespace Omega_h
+
+#endif
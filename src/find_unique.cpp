@@ -1,9 +1,11 @@
 #include "adjacency.hpp"
 
 #include "align.hpp"
+#include "array.hpp"
 #include "loop.hpp"
 #include "map.hpp"
 #include "sort.hpp"
+#include "vert_hash.hpp"
 
 namespace Omega_h {
 
@@ -87,7 +89,63 @@ Read<I8> find_canonical_jumps(Int deg, LOs canon, LOs e_sorted2e) {
   return jumps;
 }
 
+static bool hashed_matching_enabled = false;
+
+void enable_hashed_matching(bool yn) { hashed_matching_enabled = yn; }
+
+bool is_hashed_matching_enabled() { return hashed_matching_enabled; }
+
+VertHash make_vert_hash(LO nents, LO nverts) {
+  LO capacity = 1;
+  while (capacity < 2 * nents) capacity *= 2;
+  VertHash table;
+  table.slots = Write<LO>(capacity, -1);
+  table.stride = max2<LO>(1, capacity / max2<LO>(1, nverts));
+  return table;
+}
+
+/* the sorting path below picks the last use of each entity,
+   so the hash table keeps the largest use index in each slot,
+   and then only those representatives need sorting */
+template <Int deg>
+static LOs find_unique_by_hash_deg(LOs uv2v) {
+  LO nu = uv2v.size() / deg;
+  auto table = make_vert_hash(nu, (nu ? max(uv2v) : -1) + 1);
+  auto slots = table.slots;
+  Write<LO> uses2slots(nu);
+  auto insert = LAMBDA(LO u) {
+    LO v[deg];
+    get_sorted_verts<deg>(uv2v, u, v);
+    auto slot = insert_vert_list<deg>(table, uv2v, u, v);
+    atomic_max<LO>(&slots[slot], u);
+    uses2slots[u] = slot;
+  };
+  parallel_for(nu, insert);
+  Write<I8> are_reps(nu);
+  auto mark = LAMBDA(LO u) { are_reps[u] = (slots[uses2slots[u]] == u); };
+  parallel_for(nu, mark);
+  auto reps2uses = collect_marked(Read<I8>(are_reps));
+  auto nreps = reps2uses.size();
+  Write<LO> rep_keys(nreps * deg);
+  auto gather = LAMBDA(LO rep) {
+    LO v[deg];
+    get_sorted_verts<deg>(uv2v, reps2uses[rep], v);
+    for (Int i = 0; i < deg; ++i) rep_keys[rep * deg + i] = v[i];
+  };
+  parallel_for(nreps, gather);
+  auto sorted2reps = sort_by_keys(LOs(rep_keys), deg);
+  auto e2u = compound_maps(sorted2reps, reps2uses);
+  return unmap<LO>(e2u, uv2v, deg);
+}
+
+static LOs find_unique_by_hash(Int deg, LOs uv2v) {
+  if (deg == 3) return find_unique_by_hash_deg<3>(uv2v);
+  if (deg == 2) return find_unique_by_hash_deg<2>(uv2v);
+  NORETURN(LOs());
+}
+
 static LOs find_unique_deg(Int deg, LOs uv2v) {
+  if (is_hashed_matching_enabled()) return find_unique_by_hash(deg, uv2v);
   auto codes = get_codes_to_canonical(deg, uv2v);
   auto uv2v_canon = align_ev2v(deg, uv2v, codes);
   auto sorted2u = sort_by_keys(uv2v_canon, deg);
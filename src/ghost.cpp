@@ -1,9 +1,16 @@
 #include "ghost.hpp"
 
+#include <iostream>
+
+#include "array.hpp"
+#include "graph.hpp"
 #include "loop.hpp"
 #include "map.hpp"
+#include "mark.hpp"
 #include "migrate.hpp"
+#include "owners.hpp"
 #include "remotes.hpp"
+#include "unmap_mesh.hpp"
 
 namespace Omega_h {
 
@@ -115,6 +122,70 @@ void ghost_mesh(Mesh* mesh, Int nlayers, bool verbose) {
   *mesh = new_mesh;
 }
 
+/* every element of a ghosted mesh is present on the rank that owns it,
+ * even after the owners of cavity elements have been moved to the owner
+ * of their key (see set_owners_by_indset()), and the ghost layers around
+ * those owned elements are also present locally.
+ * dropping ghost layers is therefore a local subset of the mesh, and the
+ * only communication needed is to agree on the owners of the remaining
+ * copies.
+ * when going back to element based partitioning, those owners are chosen
+ * the same way partition_by_elems() would choose them.
+ * when only dropping some of the layers, the owners stay the same.
+ */
+void unghost_mesh(Mesh* mesh, Int nlayers, bool verbose) {
+  CHECK(mesh->parting() == OMEGA_H_GHOSTED);
+  CHECK(0 <= nlayers);
+  CHECK(nlayers < mesh->nghost_layers());
+  auto dim = mesh->dim();
+  auto comm = mesh->comm();
+  auto elems_are_kept = mesh->owned(dim);
+  for (Int i = 0; i < nlayers; ++i) {
+    auto verts_are_kept =
+        graph_reduce(mesh->ask_up(VERT, dim), elems_are_kept, 1, OMEGA_H_MAX);
+    elems_are_kept = mark_up(mesh, VERT, dim, verts_are_kept);
+  }
+  LOs new_ents2old_ents[4];
+  for (Int ent_dim = VERT; ent_dim < dim; ++ent_dim) {
+    auto ents_are_kept = graph_reduce(
+        mesh->ask_up(ent_dim, dim), elems_are_kept, 1, OMEGA_H_MAX);
+    new_ents2old_ents[ent_dim] = collect_marked(ents_are_kept);
+  }
+  new_ents2old_ents[dim] = collect_marked(elems_are_kept);
+  if (verbose) {
+    auto nkept =
+        comm->allreduce(GO(new_ents2old_ents[dim].size()), OMEGA_H_SUM);
+    auto ntotal = comm->allreduce(GO(mesh->nelems()), OMEGA_H_SUM);
+    if (comm->rank() == 0) {
+      std::cout << "unghosting keeps (" << nkept << ") / (" << ntotal
+                << ") element copies\n";
+    }
+  }
+  auto new_mesh = mesh->copy_meta();
+  new_mesh.set_verts(new_ents2old_ents[VERT].size());
+  LOs old_lows2new_lows;
+  for (Int ent_dim = VERT; ent_dim <= dim; ++ent_dim) {
+    auto new_ents2old = new_ents2old_ents[ent_dim];
+    auto old_ents2new = invert_injective_map(new_ents2old, mesh->nents(ent_dim));
+    if (ent_dim > VERT) {
+      unmap_down(mesh, &new_mesh, ent_dim, new_ents2old, old_lows2new_lows);
+    }
+    unmap_tags(mesh, &new_mesh, ent_dim, new_ents2old);
+    if (nlayers == 0) {
+      auto copies2old_owners = unmap(new_ents2old, mesh->ask_owners(ent_dim));
+      auto copies2old_owners_dist =
+          Dist(comm, copies2old_owners, mesh->nents(ent_dim));
+      new_mesh.set_owners(
+          ent_dim, update_ownership(copies2old_owners_dist, Read<I32>()));
+    } else {
+      unmap_owners(mesh, &new_mesh, ent_dim, new_ents2old, old_ents2new);
+      CHECK(min(new_mesh.ask_owners(ent_dim).idxs) >= 0);
+    }
+    old_lows2new_lows = old_ents2new;
+  }
+  *mesh = new_mesh;
+}
+
 void partition_by_verts(Mesh* mesh, bool verbose) {
   /* vertex-based partitioning is defined as gathering the elements
    * adjacent to owned vertices, hence the graph from owned vertices
@@ -23,6 +23,7 @@ void get_own_verts2own_elem_uses(
 Remotes push_elem_uses(RemoteGraph own_verts2own_elems, Dist own_verts2verts);
 
 void ghost_mesh(Mesh* mesh, Int nlayers, bool verbose);
+void unghost_mesh(Mesh* mesh, Int nlayers, bool verbose);
 void partition_by_verts(Mesh* mesh, bool verbose);
 void partition_by_elems(Mesh* mesh, bool verbose);
 
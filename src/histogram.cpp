@@ -2,6 +2,7 @@
 #include <iomanip>
 #include <iostream>
 #include "array.hpp"
+#include "expr.hpp"
 
 namespace Omega_h {
 
@@ -16,9 +17,8 @@ Histogram<n> get_histogram(
   for (Int i = 0; i < n; ++i) {
     auto floor = interval * i + min_value;
     auto ceil = interval * (i + 1) + min_value;
-    auto marked = land_each(
-        each_geq_to(owned_values, floor), each_lt(owned_values, ceil));
-    auto nlocal_marked = sum(marked);
+    auto nlocal_marked =
+        sum(lazy(owned_values) >= floor && lazy(owned_values) < ceil);
     auto nglobal_marked = mesh->comm()->allreduce(nlocal_marked, OMEGA_H_SUM);
     histogram.counts[i] = nglobal_marked;
   }
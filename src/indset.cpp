@@ -1,10 +1,25 @@
 #include "indset.hpp"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "array.hpp"
 #include "loop.hpp"
 
 namespace Omega_h {
 
+static bool randomized_indset_enabled = false;
+
+void enable_randomized_indset(bool yn) { randomized_indset_enabled = yn; }
+
+bool is_randomized_indset_enabled() { return randomized_indset_enabled; }
+
+static IndsetStats indset_stats = {0, 0, 0, 0};
+
+IndsetStats get_indset_stats() { return indset_stats; }
+
+void reset_indset_stats() { indset_stats = IndsetStats{0, 0, 0, 0}; }
+
 namespace indset {
 
 enum { NOT_IN, IN, UNKNOWN };
@@ -44,9 +59,63 @@ static Read<I8> local_iteration(
   return new_state;
 }
 
+/* a priority that depends only on the global number and the round,
+   so every rank and every partitioning agrees on it */
+INLINE std::uint64_t luby_priority(GO global, Int round) {
+  auto x = static_cast<std::uint64_t>(global) +
+           0x9E3779B97F4A7C15ull * static_cast<std::uint64_t>(round + 1);
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+/* the same rule, but ties in quality are broken by a hash that changes
+   every round instead of by global number. equal qualities are common
+   (structured regions, uniform fields), and breaking their ties by
+   global number decides them one after the other along chains of
+   increasing numbers. hashed ties make each round a round of Luby's
+   algorithm over those regions, deciding them in O(log n) rounds
+   in expectation */
+static Read<I8> luby_iteration(LOs xadj, LOs adj, Reals quality,
+    Read<GO> global, Read<I8> old_state, Int round) {
+  auto n = global.size();
+  Write<I8> new_state = deep_copy(old_state);
+  auto f = LAMBDA(LO v) {
+    if (old_state[v] != UNKNOWN) return;
+    auto begin = xadj[v];
+    auto end = xadj[v + 1];
+    for (auto j = begin; j < end; ++j) {
+      if (old_state[adj[j]] == IN) {
+        new_state[v] = NOT_IN;
+        return;
+      }
+    }
+    auto v_qual = quality[v];
+    auto v_prio = luby_priority(global[v], round);
+    for (auto j = begin; j < end; ++j) {
+      auto u = adj[j];
+      if (old_state[u] == NOT_IN) continue;
+      auto u_qual = quality[u];
+      if (u_qual > v_qual) return;
+      if (u_qual < v_qual) continue;
+      auto u_prio = luby_priority(global[u], round);
+      if (u_prio > v_prio) return;
+      if (u_prio == v_prio && global[u] > global[v]) return;
+    }
+    new_state[v] = IN;
+  };
+  parallel_for(n, f);
+  return new_state;
+}
+
 static Read<I8> iteration(Mesh* mesh, Int dim, LOs xadj, LOs adj, Reals quality,
-    Read<GO> global, Read<I8> old_state) {
-  auto local_state = local_iteration(xadj, adj, quality, global, old_state);
+    Read<GO> global, Read<I8> old_state, Int round) {
+  Read<I8> local_state;
+  if (is_randomized_indset_enabled()) {
+    local_state = luby_iteration(xadj, adj, quality, global, old_state, round);
+  } else {
+    local_state = local_iteration(xadj, adj, quality, global, old_state);
+  }
   auto synced_state = mesh->sync_array(dim, local_state, 1);
   return synced_state;
 }
@@ -66,9 +135,23 @@ static Read<I8> find(Mesh* mesh, Int dim, LOs xadj, LOs adj, Reals quality,
   parallel_for(n, f);
   auto comm = mesh->comm();
   auto state = Read<I8>(initial_state);
+  /* once every node is decided, further rounds change nothing.
+     with hashed ties few rounds are needed, so checking for that after
+     every other one saves more reductions than it wastes exchanges */
+  Int rounds_per_check = is_randomized_indset_enabled() ? 2 : 1;
+  Int round = 0;
+  ++indset_stats.ncalls;
   while (comm->allreduce(max(state), OMEGA_H_MAX) == UNKNOWN) {
-    state = iteration(mesh, dim, xadj, adj, quality, global, state);
+    ++indset_stats.nreductions;
+    for (Int i = 0; i < rounds_per_check; ++i) {
+      state = iteration(mesh, dim, xadj, adj, quality, global, state, round);
+      ++round;
+    }
   }
+  ++indset_stats.nreductions;
+  indset_stats.nrounds += std::size_t(round);
+  indset_stats.max_rounds =
+      std::max(indset_stats.max_rounds, std::size_t(round));
   return state;
 }
 }
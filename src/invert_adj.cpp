@@ -1,34 +1,83 @@
 #include "adjacency.hpp"
 
 #include "align.hpp"
+#include "array.hpp"
 #include "loop.hpp"
 #include "map.hpp"
+#include "scan.hpp"
+#include "sort.hpp"
 
 namespace Omega_h {
 
-static void order_by_globals(
+/* segments (the upward lists of single lows) up to this long are
+   insertion sorted by one thread each, longer ones are gathered
+   and sorted together by sort_by_keys(), so that the few high-valence
+   lows don't serialize the whole inversion. */
+enum { MAX_INSERTION_SORT = 32 };
+
+static void sort_short_segments(
     LOs l2lh, Write<LO> lh2h, Write<I8> codes, Read<GO> hg) {
   LO nl = l2lh.size() - 1;
   auto f = LAMBDA(LO l) {
     LO begin = l2lh[l];
     LO end = l2lh[l + 1];
+    if (end - begin > MAX_INSERTION_SORT) return;
+    GO keys[MAX_INSERTION_SORT];
     for (LO j = begin; j < end; ++j) {
-      LO k_min = j;
-      GO min_g = hg[lh2h[j]];
-      for (LO k = j + 1; k < end; ++k) {
-        GO g = hg[lh2h[k]];
-        if (g < min_g) {
-          k_min = k;
-          min_g = g;
-        }
+      auto h = lh2h[j];
+      auto code = codes[j];
+      auto g = hg[h];
+      LO k = j - begin;
+      for (; k > 0 && keys[k - 1] > g; --k) {
+        keys[k] = keys[k - 1];
+        lh2h[begin + k] = lh2h[begin + k - 1];
+        codes[begin + k] = codes[begin + k - 1];
       }
-      swap2(lh2h[j], lh2h[k_min]);
-      swap2(codes[j], codes[k_min]);
+      keys[k] = g;
+      lh2h[begin + k] = h;
+      codes[begin + k] = code;
     }
   };
   parallel_for(nl, f);
 }
 
+static void sort_long_segments(
+    LOs l2lh, Write<LO> lh2h, Write<I8> codes, Read<GO> hg) {
+  auto degrees = get_degrees(l2lh);
+  auto longs2ls = collect_marked(each_gt(degrees, LO(MAX_INSERTION_SORT)));
+  if (longs2ls.size() == 0) return;
+  auto longs2uses = offset_scan(unmap(longs2ls, degrees, 1));
+  auto uses2longs = invert_fan(longs2uses);
+  auto nuses = longs2uses.last();
+  Write<LO> uses2lh(nuses);
+  Write<LO> use_highs(nuses);
+  Write<I8> use_codes(nuses);
+  Write<GO> keys(nuses * 2);
+  auto gather = LAMBDA(LO use) {
+    auto long_l = uses2longs[use];
+    auto lh = l2lh[longs2ls[long_l]] + (use - longs2uses[long_l]);
+    uses2lh[use] = lh;
+    use_highs[use] = lh2h[lh];
+    use_codes[use] = codes[lh];
+    keys[use * 2 + 0] = long_l;
+    keys[use * 2 + 1] = hg[lh2h[lh]];
+  };
+  parallel_for(nuses, gather);
+  auto perm = sort_by_keys(Read<GO>(keys), 2);
+  auto scatter = LAMBDA(LO use) {
+    auto lh = uses2lh[use];
+    lh2h[lh] = use_highs[perm[use]];
+    codes[lh] = use_codes[perm[use]];
+  };
+  parallel_for(nuses, scatter);
+}
+
+void order_by_globals(
+    LOs l2lh, Write<LO> lh2h, Write<I8> codes, Read<GO> hg) {
+  sort_short_segments(l2lh, lh2h, codes, hg);
+  sort_long_segments(l2lh, lh2h, codes, hg);
+}
+
 Adj invert_adj(Adj down, Int nlows_per_high, LO nlows, Read<GO> high_globals) {
   auto l2hl = invert_map_by_atomics(down.ab2b, nlows);
   auto l2lh = l2hl.a2ab;
@@ -1,29 +1,118 @@
 #ifndef LOOP_HPP
 #define LOOP_HPP
 
+#include <typeinfo>
+
 #include "internal.hpp"
+#include "trace.hpp"
+
+#ifdef OMEGA_H_USE_THREADS
+#include <vector>
+
+#include "threads.hpp"
+#endif
 
 namespace Omega_h {
 
+#ifdef OMEGA_H_USE_THREADS
+namespace threads {
+
+template <typename T>
+struct ForClosure {
+  T const* f;
+  Chunking chunking;
+  static void run(void const* p, LO c) {
+    auto cl = static_cast<ForClosure<T> const*>(p);
+    auto end = cl->chunking.end(c);
+    for (LO i = cl->chunking.begin(c); i < end; ++i) (*cl->f)(i);
+  }
+};
+
+template <typename T>
+struct ReduceClosure {
+  typedef typename T::value_type VT;
+  T const* f;
+  Chunking chunking;
+  VT* partials;
+  static void run(void const* p, LO c) {
+    auto cl = static_cast<ReduceClosure<T> const*>(p);
+    auto& update = cl->partials[c];
+    cl->f->init(update);
+    auto end = cl->chunking.end(c);
+    for (LO i = cl->chunking.begin(c); i < end; ++i) (*cl->f)(i, update);
+  }
+};
+
+/* the first pass fills (partials) with each chunk's total,
+   the second pass starts each chunk from the combined totals
+   of the chunks before it, which are then in (partials) */
+template <typename T>
+struct ScanClosure {
+  typedef typename T::value_type VT;
+  T const* f;
+  Chunking chunking;
+  VT* partials;
+  bool final_pass;
+  static void run(void const* p, LO c) {
+    auto cl = static_cast<ScanClosure<T> const*>(p);
+    VT update;
+    if (cl->final_pass) {
+      update = cl->partials[c];
+    } else {
+      cl->f->init(update);
+    }
+    auto end = cl->chunking.end(c);
+    for (LO i = cl->chunking.begin(c); i < end; ++i) {
+      (*cl->f)(i, update, cl->final_pass);
+    }
+    if (!cl->final_pass) cl->partials[c] = update;
+  }
+};
+
+}  // end namespace threads
+#endif
+
 template <typename T>
 void parallel_for(Int n, T const& f) {
-#ifdef OMEGA_H_USE_KOKKOS
+  tracing::KernelScope trace_scope(typeid(T), "parallel_for", n);
+#if defined(OMEGA_H_USE_KOKKOS)
   if (n > 0) Kokkos::parallel_for(static_cast<std::size_t>(n), f);
 #else
+#if defined(OMEGA_H_USE_THREADS)
+  threads::Chunking chunking(n);
+  if (threads::can_fork(chunking.nchunks)) {
+    threads::ForClosure<T> closure = {&f, chunking};
+    threads::run_chunks(
+        chunking.nchunks, threads::ForClosure<T>::run, &closure);
+    return;
+  }
+#endif
   for (Int i = 0; i < n; ++i) f(i);
 #endif
 }
 
 template <typename T>
 typename T::value_type parallel_reduce(Int n, T f) {
+  tracing::KernelScope trace_scope(typeid(T), "parallel_reduce", n);
   typedef typename T::value_type VT;
   static_assert(sizeof(VT) >= sizeof(void*),
       "reduction value types need to be at least word-sized");
   VT result;
   f.init(result);
-#ifdef OMEGA_H_USE_KOKKOS
+#if defined(OMEGA_H_USE_KOKKOS)
   if (n > 0) Kokkos::parallel_reduce(static_cast<std::size_t>(n), f, result);
 #else
+#if defined(OMEGA_H_USE_THREADS)
+  threads::Chunking chunking(n);
+  if (threads::can_fork(chunking.nchunks)) {
+    std::vector<VT> partials(static_cast<std::size_t>(chunking.nchunks));
+    threads::ReduceClosure<T> closure = {&f, chunking, partials.data()};
+    threads::run_chunks(
+        chunking.nchunks, threads::ReduceClosure<T>::run, &closure);
+    for (LO c = 0; c < chunking.nchunks; ++c) f.join(result, partials[c]);
+    return result;
+  }
+#endif
   for (Int i = 0; i < n; ++i) f(i, result);
 #endif
   return result;
@@ -31,12 +120,33 @@ typename T::value_type parallel_reduce(Int n, T f) {
 
 template <typename T>
 void parallel_scan(Int n, T f) {
+  tracing::KernelScope trace_scope(typeid(T), "parallel_scan", n);
   typedef typename T::value_type VT;
   static_assert(sizeof(VT) >= sizeof(void*),
       "reduction value types need to be at least word-sized");
-#ifdef OMEGA_H_USE_KOKKOS
+#if defined(OMEGA_H_USE_KOKKOS)
   if (n > 0) Kokkos::parallel_scan(static_cast<std::size_t>(n), f);
 #else
+#if defined(OMEGA_H_USE_THREADS)
+  threads::Chunking chunking(n);
+  if (threads::can_fork(chunking.nchunks)) {
+    std::vector<VT> partials(static_cast<std::size_t>(chunking.nchunks));
+    threads::ScanClosure<T> closure = {&f, chunking, partials.data(), false};
+    threads::run_chunks(
+        chunking.nchunks, threads::ScanClosure<T>::run, &closure);
+    VT running;
+    f.init(running);
+    for (LO c = 0; c < chunking.nchunks; ++c) {
+      VT total = partials[c];
+      partials[c] = running;
+      f.join(running, total);
+    }
+    closure.final_pass = true;
+    threads::run_chunks(
+        chunking.nchunks, threads::ScanClosure<T>::run, &closure);
+    return;
+  }
+#endif
   VT update;
   f.init(update);
   for (Int i = 0; i < n; ++i) f(i, update, true);
@@ -2,6 +2,7 @@
 
 #include "array.hpp"
 #include "atomics.hpp"
+#include "bits.hpp"
 #include "loop.hpp"
 #include "scan.hpp"
 #include "sort.hpp"
@@ -42,6 +43,20 @@ Read<T> unmap(LOs a2b, Read<T> b_data, Int width) {
   return a_data;
 }
 
+template <typename T>
+void unmap_into(LOs a2b, Read<T> b_data, LOs a2c, Write<T> c_data, Int width) {
+  auto na = a2b.size();
+  CHECK(a2c.size() == na);
+  auto f = LAMBDA(LO a) {
+    auto b = a2b[a];
+    auto c = a2c[a];
+    for (Int j = 0; j < width; ++j) {
+      c_data[c * width + j] = b_data[b * width + j];
+    }
+  };
+  parallel_for(na, f);
+}
+
 template <typename T>
 Read<T> expand(Read<T> a_data, LOs a2b, Int width) {
   auto na = a2b.size() - 1;
@@ -102,14 +117,31 @@ Read<I8> invert_marks(Read<I8> marks) {
 }
 
 LOs collect_marked(Read<I8> marks) {
-  auto ntotal = marks.size();
-  auto offsets = offset_scan(marks);
-  auto nmarked = offsets.last();
-  Write<LO> marked(nmarked);
-  auto f = LAMBDA(LO i) {
-    if (marks[i]) marked[offsets[i]] = i;
+  auto is_marked = LAMBDA(LO i) { return marks[i] != 0; };
+  return collect_if(marks.size(), is_marked);
+}
+
+/* each word finds its first output slot from a scan of the
+   words' popcounts, then writes out its set bits in order */
+LOs collect_marked(Bits marks) {
+  auto words = marks.words();
+  auto nwords = marks.nwords();
+  Write<LO> word_counts(nwords);
+  auto count = LAMBDA(LO w) {
+    word_counts[w] = popcount(static_cast<std::uint32_t>(words[w]));
+  };
+  parallel_for(nwords, count);
+  auto offsets = offset_scan(LOs(word_counts));
+  Write<LO> marked(offsets.last());
+  auto f = LAMBDA(LO w) {
+    auto word = static_cast<std::uint32_t>(words[w]);
+    auto j = offsets[w];
+    while (word) {
+      marked[j++] = w * 32 + count_trailing_zeros(word);
+      word &= word - 1;
+    }
   };
-  parallel_for(ntotal, f);
+  parallel_for(nwords, f);
   return marked;
 }
 
@@ -240,6 +272,8 @@ Read<T> fan_reduce(LOs a2b, Read<T> b_data, Int width, Omega_h_Op op) {
   template void map_into(Read<T> a_data, LOs a2b, Write<T> b_data, Int width); \
   template Read<T> map_onto(Read<T> a_data, LOs a2b, LO nb, T, Int width);     \
   template Read<T> unmap(LOs a2b, Read<T> b_data, Int width);                  \
+  template void unmap_into(                                                    \
+      LOs a2b, Read<T> b_data, LOs a2c, Write<T> c_data, Int width);           \
   template Read<T> expand(Read<T> a_data, LOs a2b, Int width);                 \
   template Read<T> permute(Read<T> a_data, LOs a2b, Int width);                \
   template Read<T> fan_reduce(                                                 \
@@ -14,6 +14,12 @@ Read<T> map_onto(Read<T> a_data, LOs a2b, LO nb, T init_val, Int width);
 template <typename T>
 Read<T> unmap(LOs a2b, Read<T> b_data, Int width);
 
+/* equivalent to map_into(unmap(a2b, b_data, width), a2c, c_data, width)
+   without the intermediate array, used to carry entities that a
+   modification keeps straight from the old mesh into the new one */
+template <typename T>
+void unmap_into(LOs a2b, Read<T> b_data, LOs a2c, Write<T> c_data, Int width);
+
 template <typename T>
 Read<T> expand(Read<T> a_data, LOs a2b, Int width);
 
@@ -54,6 +60,8 @@ Read<T> fan_reduce(LOs a2b, Read<T> b_data, Int width, Omega_h_Op op);
   extern template Read<T> map_onto(                                            \
       Read<T> a_data, LOs a2b, LO nb, T, Int width);                           \
   extern template Read<T> unmap(LOs a2b, Read<T> b_data, Int width);           \
+  extern template void unmap_into(                                             \
+      LOs a2b, Read<T> b_data, LOs a2c, Write<T> c_data, Int width);           \
   extern template Read<T> expand(Read<T> a_data, LOs a2b, Int width);          \
   extern template Read<T> permute(Read<T> a_data, LOs a2b, Int width);         \
   extern template Read<T> fan_reduce(                                          \
@@ -1,6 +1,7 @@
 #include "mark.hpp"
 
 #include "array.hpp"
+#include "expr.hpp"
 #include "graph.hpp"
 #include "loop.hpp"
 #include "simplices.hpp"
@@ -97,10 +98,13 @@ Read<I8> mark_dual_layers(Mesh* mesh, Read<I8> marks, Int nlayers) {
 }
 
 GO count_owned_marks(Mesh* mesh, Int ent_dim, Read<I8> marks) {
+  auto comm = mesh->comm();
   if (mesh->could_be_shared(ent_dim)) {
-    marks = land_each(marks, mesh->owned(ent_dim));
+    auto ranks = mesh->ask_owners(ent_dim).ranks;
+    auto nowned_marks = sum(lazy(marks) && lazy(ranks) == comm->rank());
+    return comm->allreduce(GO(nowned_marks), OMEGA_H_SUM);
   }
-  return mesh->comm()->allreduce(GO(sum(marks)), OMEGA_H_SUM);
+  return comm->allreduce(GO(sum(marks)), OMEGA_H_SUM);
 }
 
 Read<I8> mark_sliver_layers(Mesh* mesh, Real qual_ceil, Int nlayers) {
@@ -110,4 +114,65 @@ Read<I8> mark_sliver_layers(Mesh* mesh, Real qual_ceil, Int nlayers) {
   return mark_dual_layers(mesh, elems_are_slivers, nlayers);
 }
 
+bool restricts_adapt_region(AdaptOpts const& opts) {
+  return !opts.region_class_ids.empty();
+}
+
+/* the elements having an entity classified on one of the region's
+   model entities, grown by layers of elements that share a vertex
+   with them. works in any parting, since mark_down synchronizes the
+   vertex marks.
+   the marks are kept as an "adapt_region" tag, so they are computed
+   once per rebuild: rebuilds drop the tag (OMEGA_H_DONT_TRANSFER)
+   while migration carries it along with the classification. */
+static Read<I8> mark_adapt_region_elems(Mesh* mesh, AdaptOpts const& opts) {
+  CHECK(opts.region_class_dims.size() == opts.region_class_ids.size());
+  auto dim = mesh->dim();
+  auto elems_are_in = Read<I8>(mesh->nelems(), 0);
+  for (std::size_t i = 0; i < opts.region_class_ids.size(); ++i) {
+    auto class_dim = opts.region_class_dims[i];
+    auto class_id = opts.region_class_ids[i];
+    auto ents_are_in = mark_by_class(mesh, class_dim, class_dim, class_id);
+    if (class_dim < dim) {
+      ents_are_in = mark_up(mesh, class_dim, dim, ents_are_in);
+    }
+    elems_are_in = lor_each(elems_are_in, ents_are_in);
+  }
+  for (Int i = 0; i < opts.nregion_layers; ++i) {
+    auto verts_are_in = mark_down(mesh, dim, VERT, elems_are_in);
+    elems_are_in = mark_up(mesh, VERT, dim, verts_are_in);
+  }
+  return elems_are_in;
+}
+
+Read<I8> mark_adapt_region(Mesh* mesh, AdaptOpts const& opts, Int ent_dim) {
+  if (mesh->has_tag(ent_dim, "adapt_region")) {
+    return mesh->get_array<I8>(ent_dim, "adapt_region");
+  }
+  auto dim = mesh->dim();
+  Read<I8> marks;
+  if (ent_dim == dim) {
+    marks = mark_adapt_region_elems(mesh, opts);
+  } else {
+    marks = mark_down(mesh, dim, ent_dim, mark_adapt_region(mesh, opts, dim));
+  }
+  mesh->add_tag(ent_dim, "adapt_region", 1, OMEGA_H_DONT_TRANSFER,
+      OMEGA_H_DONT_OUTPUT, marks);
+  return marks;
+}
+
+void forget_adapt_region(Mesh* mesh) {
+  for (Int ent_dim = 0; ent_dim <= mesh->dim(); ++ent_dim) {
+    if (mesh->has_tag(ent_dim, "adapt_region")) {
+      mesh->remove_tag(ent_dim, "adapt_region");
+    }
+  }
+}
+
+Read<I8> restrict_to_adapt_region(
+    Mesh* mesh, AdaptOpts const& opts, Int ent_dim, Read<I8> marks) {
+  if (!restricts_adapt_region(opts)) return marks;
+  return land_each(marks, mark_adapt_region(mesh, opts, ent_dim));
+}
+
 }  // end namespace Omega_h
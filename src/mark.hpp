@@ -22,6 +22,12 @@ GO count_owned_marks(Mesh* mesh, Int ent_dim, Read<I8> marks);
 
 Read<I8> mark_sliver_layers(Mesh* mesh, Real qual_ceil, Int nlayers);
 
+bool restricts_adapt_region(AdaptOpts const& opts);
+Read<I8> mark_adapt_region(Mesh* mesh, AdaptOpts const& opts, Int ent_dim);
+void forget_adapt_region(Mesh* mesh);
+Read<I8> restrict_to_adapt_region(
+    Mesh* mesh, AdaptOpts const& opts, Int ent_dim, Read<I8> marks);
+
 }  // end namespace Omega_h
 
 #endif
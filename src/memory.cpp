@@ -0,0 +1,157 @@
+#include "memory.hpp"
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+namespace Omega_h {
+
+/* label counters live in a fixed-size table so that
+   their addresses never change and threads can update
+   them with plain atomics; only creating a label
+   or taking a peak snapshot needs the mutex. */
+enum { MAX_MEMORY_LABELS = 256 };
+
+struct LabelCounters {
+  std::string name;
+  std::atomic<std::size_t> current_bytes;
+  std::atomic<std::size_t> max_bytes;
+  std::atomic<std::size_t> nallocs;
+  std::size_t bytes_at_peak;
+};
+
+struct MemoryBook {
+  LabelCounters labels[MAX_MEMORY_LABELS];
+  std::atomic<Int> nlabels;
+  std::map<std::string, Int> ids;
+  std::atomic<std::size_t> current_bytes;
+  std::atomic<std::size_t> max_bytes;
+  std::atomic<std::size_t> allocated_bytes;
+  std::mutex mutex;
+  MemoryBook()
+      : nlabels(0), current_bytes(0), max_bytes(0), allocated_bytes(0) {
+    for (auto& label : labels) {
+      label.current_bytes = 0;
+      label.max_bytes = 0;
+      label.nallocs = 0;
+      label.bytes_at_peak = 0;
+    }
+  }
+};
+
+static MemoryBook& get_book() {
+  static MemoryBook book;
+  return book;
+}
+
+static thread_local Int thread_memory_label = 0;
+
+static void raise_to(std::atomic<std::size_t>& max, std::size_t value) {
+  auto old = max.load();
+  while (old < value && !max.compare_exchange_weak(old, value))
+    ;
+}
+
+Int find_memory_label(std::string const& name) {
+  auto& book = get_book();
+  std::lock_guard<std::mutex> lock(book.mutex);
+  if (book.nlabels == 0) {
+    book.labels[0].name = "omega_h";
+    book.ids["omega_h"] = 0;
+    book.nlabels = 1;
+  }
+  auto it = book.ids.find(name);
+  if (it != book.ids.end()) return it->second;
+  Int id = book.nlabels;
+  if (id == MAX_MEMORY_LABELS) {
+    Omega_h_fail("more than %d memory labels\n", int(MAX_MEMORY_LABELS));
+  }
+  book.labels[id].name = name;
+  book.ids[name] = id;
+  book.nlabels = id + 1;
+  return id;
+}
+
+Int current_memory_label() { return thread_memory_label; }
+
+std::string const& memory_label_name(Int label) {
+  if (label == 0) find_memory_label("omega_h");
+  return get_book().labels[label].name;
+}
+
+void record_allocation(Int label, std::size_t bytes) {
+  auto& book = get_book();
+  auto& counters = book.labels[label];
+  ++counters.nallocs;
+  raise_to(counters.max_bytes, (counters.current_bytes += bytes));
+  book.allocated_bytes += bytes;
+  auto total = (book.current_bytes += bytes);
+  if (total > book.max_bytes.load()) {
+    std::lock_guard<std::mutex> lock(book.mutex);
+    if (total > book.max_bytes.load()) {
+      book.max_bytes = total;
+      Int n = book.nlabels;
+      for (Int i = 0; i < n; ++i) {
+        book.labels[i].bytes_at_peak = book.labels[i].current_bytes;
+      }
+    }
+  }
+}
+
+void record_deallocation(Int label, std::size_t bytes) {
+  auto& book = get_book();
+  book.labels[label].current_bytes -= bytes;
+  book.current_bytes -= bytes;
+}
+
+std::size_t get_current_bytes() { return get_book().current_bytes; }
+
+std::size_t get_max_bytes() { return get_book().max_bytes; }
+
+std::size_t get_allocated_bytes() { return get_book().allocated_bytes; }
+
+ScopedMemoryLabel::ScopedMemoryLabel(std::string const& name)
+    : previous_(thread_memory_label) {
+  thread_memory_label = find_memory_label(name);
+}
+
+ScopedMemoryLabel::~ScopedMemoryLabel() { thread_memory_label = previous_; }
+
+std::vector<MemoryLabelStats> get_memory_report() {
+  auto& book = get_book();
+  find_memory_label("omega_h");
+  std::lock_guard<std::mutex> lock(book.mutex);
+  std::vector<MemoryLabelStats> report;
+  Int n = book.nlabels;
+  for (Int i = 0; i < n; ++i) {
+    auto& counters = book.labels[i];
+    MemoryLabelStats stats;
+    stats.label = counters.name;
+    stats.current_bytes = counters.current_bytes;
+    stats.max_bytes = counters.max_bytes;
+    stats.bytes_at_peak = counters.bytes_at_peak;
+    stats.nallocs = counters.nallocs;
+    report.push_back(stats);
+  }
+  return report;
+}
+
+void print_memory_report(std::ostream& stream) {
+  auto report = get_memory_report();
+  std::ios::fmtflags stream_state(stream.flags());
+  stream << "peak Omega_h memory: " << get_max_bytes() << " bytes\n";
+  stream << std::setw(32) << std::left << "label" << std::right
+         << std::setw(16) << "at peak" << std::setw(16) << "max"
+         << std::setw(16) << "current" << std::setw(12) << "allocs" << '\n';
+  for (auto& stats : report) {
+    stream << std::setw(32) << std::left << stats.label << std::right
+           << std::setw(16) << stats.bytes_at_peak << std::setw(16)
+           << stats.max_bytes << std::setw(16) << stats.current_bytes
+           << std::setw(12) << stats.nallocs << '\n';
+  }
+  stream.flags(stream_state);
+}
+
+}  // end namespace Omega_h
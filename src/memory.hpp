@@ -0,0 +1,21 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include "internal.hpp"
+
+namespace Omega_h {
+
+/* bookkeeping behind get_current_bytes(), get_max_bytes()
+   and the per-label memory report. labels are small integers,
+   zero being the default "omega_h" label. */
+Int current_memory_label();
+std::string const& memory_label_name(Int label);
+Int find_memory_label(std::string const& name);
+void record_allocation(Int label, std::size_t bytes);
+void record_deallocation(Int label, std::size_t bytes);
+/* total bytes ever allocated, never decreases */
+std::size_t get_allocated_bytes();
+
+}  // end namespace Omega_h
+
+#endif
@@ -2,10 +2,12 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 #include "adjacency.hpp"
 #include "array.hpp"
 #include "bcast.hpp"
+#include "bits.hpp"
 #include "ghost.hpp"
 #include "graph.hpp"
 #include "inertia.hpp"
@@ -17,6 +19,7 @@
 #include "simplices.hpp"
 #include "size.hpp"
 #include "tag.hpp"
+#include "timer.hpp"
 
 namespace Omega_h {
 
@@ -25,6 +28,14 @@ Mesh::Mesh(Library* library) : dim_(-1) {
   parting_ = OMEGA_H_ELEM_BASED;
   nghost_layers_ = 0;
   keeps_canonical_globals_ = true;
+  adj_clock_ = 0;
+  for (Int i = 0; i < DIMS; ++i) {
+    for (Int j = 0; j < DIMS; ++j) {
+      adj_last_use_[i][j] = 0;
+      adj_was_evicted_[i][j] = false;
+      adj_was_used_[i][j] = false;
+    }
+  }
   CHECK(library != nullptr);
   library_ = library;
 }
@@ -128,6 +139,10 @@ void Mesh::add_tag(
   CHECK(ncomps <= Int(INT8_MAX));
   CHECK(tags_[dim].size() < size_t(INT8_MAX));
   tags_[dim].push_back(TagPtr(new Tag<T>(name, ncomps, xfer, outflags)));
+  auto name_id = std::size_t(tags_[dim].back()->name_id());
+  auto& positions = tag_positions_[dim];
+  if (name_id >= positions.size()) positions.resize(name_id + 1, -1);
+  positions[name_id] = Int(tags_[dim].size() - 1);
 }
 
 template <typename T>
@@ -150,20 +165,43 @@ void Mesh::set_tag(
      when we do not want any invalidation to take place.
      the invalidation is there to prevent users changing coordinates
      etc. without updating dependent fields */
-  if (!internal) react_to_set_tag(dim, name);
+  if (!internal) react_to_set_tag(dim, tag->name_id());
   tag->set_array(array);
 }
 
-void Mesh::react_to_set_tag(Int dim, std::string const& name) {
+template <typename T>
+void Mesh::set_tag(Int dim, TagHandle<T> tag, Read<T> array, bool internal) {
+  check_dim2(dim);
+  auto pos = tag_position(dim, tag.name_id);
+  if (pos < 0) {
+    Omega_h_fail("set_tag(%s,%s): tag doesn't exist (use add_tag first)\n",
+        plural_names[dim], get_tag_name(tag.name_id).c_str());
+  }
+  auto t = to<T>(tags_[dim][std::size_t(pos)].get());
+  CHECK(array.size() == nents(dim) * t->ncomps());
+  if (!internal) react_to_set_tag(dim, tag.name_id);
+  t->set_array(array);
+}
+
+static TagHandle<Real> const coords_tag("coordinates");
+static TagHandle<Real> const size_tag("size");
+static TagHandle<Real> const metric_tag("metric");
+static TagHandle<Real> const length_tag("length");
+static TagHandle<Real> const quality_tag("quality");
+static TagHandle<GO> const global_tag("global");
+
+void Mesh::react_to_set_tag(Int dim, Int name_id) {
   /* hardcoded cache invalidations */
-  if ((dim == VERT) &&
-      ((name == "coordinates") || (name == "size") || (name == "metric"))) {
-    if (has_tag(EDGE, "length")) {
+  if (dim != VERT) return;
+  auto is_coords = (name_id == coords_tag.name_id);
+  auto is_metric = (name_id == metric_tag.name_id);
+  if (is_coords || is_metric || name_id == size_tag.name_id) {
+    if (has_tag(EDGE, length_tag)) {
       remove_tag(EDGE, "length");
     }
   }
-  if ((dim == VERT) && ((name == "coordinates") || (name == "metric"))) {
-    if (has_tag(this->dim(), "quality")) {
+  if (is_coords || is_metric) {
+    if (has_tag(this->dim(), quality_tag)) {
       remove_tag(this->dim(), "quality");
     }
   }
@@ -188,16 +226,36 @@ Read<T> Mesh::get_array(Int dim, std::string const& name) const {
   return get_tag<T>(dim, name)->array();
 }
 
+template <typename T>
+Read<T> Mesh::get_array(Int dim, TagHandle<T> tag) const {
+  check_dim2(dim);
+  auto pos = tag_position(dim, tag.name_id);
+  if (pos < 0) {
+    Omega_h_fail("get_array(%s,%s): doesn't exist\n", plural_names[dim],
+        get_tag_name(tag.name_id).c_str());
+  }
+  return to<T>(tags_[dim][std::size_t(pos)].get())->array();
+}
+
 void Mesh::remove_tag(Int dim, std::string const& name) {
   check_dim2(dim);
   CHECK(has_tag(dim, name));
   tags_[dim].erase(tag_iter(dim, name));
+  index_tags(dim);
 }
 
 bool Mesh::has_tag(Int dim, std::string const& name) const {
   check_dim(dim);
   if (!has_ents(dim)) return false;
-  return tag_iter(dim, name) != tags_[dim].end();
+  return tag_position(dim, find_tag_name(name)) >= 0;
+}
+
+template <typename T>
+bool Mesh::has_tag(Int dim, TagHandle<T> tag) const {
+  check_dim(dim);
+  if (!has_ents(dim)) return false;
+  auto pos = tag_position(dim, tag.name_id);
+  return pos >= 0 && is<T>(tags_[dim][std::size_t(pos)].get());
 }
 
 Int Mesh::ntags(Int dim) const {
@@ -223,6 +281,15 @@ bool Mesh::has_adj(Int from, Int to) const {
   return bool(adjs_[from][to]);
 }
 
+/* whether the adjacency was asked for since it was stored.
+   one given to add_up() that nobody asks for is not worth carrying
+   into the next modified mesh */
+bool Mesh::adj_was_used(Int from, Int to) const {
+  check_dim(from);
+  check_dim(to);
+  return adj_was_used_[from][to];
+}
+
 Adj Mesh::get_adj(Int from, Int to) const {
   check_dim2(from);
   check_dim2(to);
@@ -244,6 +311,13 @@ Adj Mesh::ask_up(Int from, Int to) {
   return ask_adj(from, to);
 }
 
+void Mesh::add_up(Int from, Int to, Adj up) {
+  CHECK(from < to);
+  CHECK(!has_adj(from, to));
+  add_adj(from, to, up);
+  evict_adjs(from, to);
+}
+
 Graph Mesh::ask_star(Int dim) {
   CHECK(dim < this->dim());
   return ask_adj(dim, dim);
@@ -251,20 +325,30 @@ Graph Mesh::ask_star(Int dim) {
 
 Graph Mesh::ask_dual() { return ask_adj(dim(), dim()); }
 
-struct HasName {
-  std::string const& name_;
-  HasName(std::string const& name) : name_(name) {}
-  bool operator()(std::shared_ptr<TagBase> const& a) {
-    return a->name() == name_;
-  }
-};
-
 Mesh::TagIter Mesh::tag_iter(Int dim, std::string const& name) {
-  return std::find_if(tags_[dim].begin(), tags_[dim].end(), HasName(name));
+  auto pos = tag_position(dim, find_tag_name(name));
+  if (pos < 0) return tags_[dim].end();
+  return tags_[dim].begin() + pos;
 }
 
 Mesh::TagCIter Mesh::tag_iter(Int dim, std::string const& name) const {
-  return std::find_if(tags_[dim].begin(), tags_[dim].end(), HasName(name));
+  auto pos = tag_position(dim, find_tag_name(name));
+  if (pos < 0) return tags_[dim].end();
+  return tags_[dim].begin() + pos;
+}
+
+Int Mesh::tag_position(Int dim, Int name_id) const {
+  auto const& positions = tag_positions_[dim];
+  if (name_id < 0 || std::size_t(name_id) >= positions.size()) return -1;
+  return positions[std::size_t(name_id)];
+}
+
+void Mesh::index_tags(Int dim) {
+  auto& positions = tag_positions_[dim];
+  std::fill(positions.begin(), positions.end(), -1);
+  for (std::size_t i = 0; i < tags_[dim].size(); ++i) {
+    positions[std::size_t(tags_[dim][i]->name_id())] = Int(i);
+  }
 }
 
 void Mesh::check_dim(Int dim) const {
@@ -298,6 +382,8 @@ void Mesh::add_adj(Int from, Int to, Adj adj) {
     CHECK(adj.a2ab.size() == nents(from) + 1);
   }
   adjs_[from][to] = std::make_shared<Adj>(adj);
+  adj_last_use_[from][to] = ++adj_clock_;
+  adj_was_used_[from][to] = false;
 }
 
 Adj Mesh::derive_adj(Int from, Int to) {
@@ -339,36 +425,117 @@ Adj Mesh::derive_adj(Int from, Int to) {
   NORETURN(Adj());
 }
 
+static std::size_t adj_cache_budget = std::numeric_limits<std::size_t>::max();
+static AdjCacheStats adj_cache_stats = {0, 0, 0, 0, 0, 0.0, 0.0};
+/* derivations nest (a star asks for upward adjacency, which asks for
+   downward adjacency...), only the outermost one is timed */
+static Int adj_derive_depth = 0;
+
+void set_adj_cache_budget(std::size_t bytes) { adj_cache_budget = bytes; }
+
+std::size_t get_adj_cache_budget() { return adj_cache_budget; }
+
+AdjCacheStats get_adj_cache_stats() { return adj_cache_stats; }
+
+void reset_adj_cache_stats() {
+  adj_cache_stats = AdjCacheStats{0, 0, 0, 0, 0, 0.0, 0.0};
+}
+
+static std::size_t get_adj_bytes(Adj const& adj) {
+  std::size_t bytes = 0;
+  if (adj.a2ab.exists()) bytes += adj.a2ab.size() * sizeof(LO);
+  if (adj.ab2b.exists()) bytes += adj.ab2b.size() * sizeof(LO);
+  if (adj.codes.exists()) bytes += adj.codes.size() * sizeof(I8);
+  return bytes;
+}
+
 Adj Mesh::ask_adj(Int from, Int to) {
   check_dim2(from);
   check_dim2(to);
   if (has_adj(from, to)) {
+    ++adj_cache_stats.nhits;
+    adj_last_use_[from][to] = ++adj_clock_;
+    adj_was_used_[from][to] = true;
     return get_adj(from, to);
   }
+  ScopedMemoryLabel label(std::string("adjacency ") + plural_names[from] +
+                          "->" + plural_names[to]);
+  ++adj_cache_stats.nmisses;
+  ++adj_derive_depth;
+  auto t0 = now();
   Adj derived = derive_adj(from, to);
+  auto t1 = now();
+  --adj_derive_depth;
+  auto seconds = (adj_derive_depth == 0) ? (t1 - t0) : 0.0;
+  adj_cache_stats.derive_seconds += seconds;
+  if (adj_was_evicted_[from][to]) {
+    ++adj_cache_stats.nrecomputes;
+    adj_cache_stats.recompute_seconds += seconds;
+    adj_was_evicted_[from][to] = false;
+  }
   adjs_[from][to] = std::make_shared<Adj>(derived);
+  adj_last_use_[from][to] = ++adj_clock_;
+  adj_was_used_[from][to] = true;
+  evict_adjs(from, to);
   return derived;
 }
 
+/* the downward adjacencies given to set_ents() can't be derived */
+bool Mesh::is_base_adj(Int from, Int to) const { return to + 1 == from; }
+
+std::size_t Mesh::adj_cache_bytes() const {
+  std::size_t bytes = 0;
+  for (Int from = 0; from < DIMS; ++from) {
+    for (Int to = 0; to < DIMS; ++to) {
+      if (!adjs_[from][to] || is_base_adj(from, to)) continue;
+      bytes += get_adj_bytes(*adjs_[from][to]);
+    }
+  }
+  return bytes;
+}
+
+void Mesh::evict_adjs(Int keep_from, Int keep_to) {
+  while (adj_cache_bytes() > adj_cache_budget) {
+    Int lru_from = -1;
+    Int lru_to = -1;
+    for (Int from = 0; from < DIMS; ++from) {
+      for (Int to = 0; to < DIMS; ++to) {
+        if (!adjs_[from][to] || is_base_adj(from, to)) continue;
+        if (from == keep_from && to == keep_to) continue;
+        if (lru_from == -1 ||
+            adj_last_use_[from][to] < adj_last_use_[lru_from][lru_to]) {
+          lru_from = from;
+          lru_to = to;
+        }
+      }
+    }
+    if (lru_from == -1) return;
+    ++adj_cache_stats.nevictions;
+    adj_cache_stats.evicted_bytes += get_adj_bytes(*adjs_[lru_from][lru_to]);
+    adjs_[lru_from][lru_to] = AdjPtr();
+    adj_was_evicted_[lru_from][lru_to] = true;
+  }
+}
+
 void Mesh::add_coords(Reals array) {
   add_tag<Real>(
       0, "coordinates", dim(), OMEGA_H_LINEAR_INTERP, OMEGA_H_DO_OUTPUT, array);
 }
 
-Reals Mesh::coords() const { return get_array<Real>(0, "coordinates"); }
+Reals Mesh::coords() const { return get_array(VERT, coords_tag); }
 
 void Mesh::set_coords(Reals const& array) {
   CHECK(array.size() == nverts() * dim());
-  set_tag<Real>(VERT, "coordinates", array);
+  set_tag(VERT, coords_tag, array);
 }
 
 Read<GO> Mesh::ask_globals(Int dim) {
-  if (!has_tag(dim, "global")) {
+  if (!has_tag(dim, global_tag)) {
     CHECK(comm_->size() == 1);
     add_tag(dim, "global", 1, OMEGA_H_GLOBAL, OMEGA_H_DO_OUTPUT,
         Read<GO>(nents(dim), 0, 1));
   }
-  return get_array<GO>(dim, "global");
+  return get_array(dim, global_tag);
 }
 
 void Mesh::reset_globals() {
@@ -380,19 +547,19 @@ void Mesh::reset_globals() {
 }
 
 Reals Mesh::ask_lengths() {
-  if (!has_tag(EDGE, "length")) {
+  if (!has_tag(EDGE, length_tag)) {
     auto lengths = measure_edges_metric(this);
     add_tag(EDGE, "length", 1, OMEGA_H_LENGTH, OMEGA_H_DO_OUTPUT, lengths);
   }
-  return get_array<Real>(EDGE, "length");
+  return get_array(EDGE, length_tag);
 }
 
 Reals Mesh::ask_qualities() {
-  if (!has_tag(dim(), "quality")) {
+  if (!has_tag(dim(), quality_tag)) {
     auto qualities = measure_qualities(this);
     add_tag(dim(), "quality", 1, OMEGA_H_QUALITY, OMEGA_H_DO_OUTPUT, qualities);
   }
-  return get_array<Real>(dim(), "quality");
+  return get_array(dim(), quality_tag);
 }
 
 void Mesh::set_owners(Int dim, Remotes owners) {
@@ -435,6 +602,7 @@ Omega_h_Parting Mesh::parting() const {
 Int Mesh::nghost_layers() const { return nghost_layers_; }
 
 void Mesh::set_parting(Omega_h_Parting parting, Int nlayers, bool verbose) {
+  profile::Region region("set_parting");
   if (verbose && comm_->rank() == 0) {
     std::cout << "going to ";
     switch (parting) {
@@ -460,12 +628,22 @@ void Mesh::set_parting(Omega_h_Parting parting, Int nlayers, bool verbose) {
   }
   if (parting == OMEGA_H_ELEM_BASED) {
     CHECK(nlayers == 0);
-    if (comm_->size() > 1) partition_by_elems(this, verbose);
+    if (comm_->size() > 1) {
+      if (parting_ == OMEGA_H_GHOSTED)
+        unghost_mesh(this, 0, verbose);
+      else
+        partition_by_elems(this, verbose);
+    }
   } else if (parting == OMEGA_H_GHOSTED) {
-    if (parting_ != OMEGA_H_GHOSTED || nlayers < nghost_layers_) {
+    if (parting_ != OMEGA_H_GHOSTED) {
       set_parting(OMEGA_H_ELEM_BASED, 0, false);
     }
-    if (comm_->size() > 1) ghost_mesh(this, nlayers, verbose);
+    if (comm_->size() > 1) {
+      if (nlayers < nghost_layers_)
+        unghost_mesh(this, nlayers, verbose);
+      else
+        ghost_mesh(this, nlayers, verbose);
+    }
   } else if (parting == OMEGA_H_VERT_BASED) {
     CHECK(nlayers == 1);
     if (comm_->size() > 1) partition_by_verts(this, verbose);
@@ -537,6 +715,11 @@ Read<T> Mesh::sync_array(Int ent_dim, Read<T> a, Int width) {
   return ask_dist(ent_dim).invert().exch(a, width);
 }
 
+Bits Mesh::sync_array(Int ent_dim, Bits a) {
+  if (!could_be_shared(ent_dim)) return a;
+  return ask_dist(ent_dim).invert().exch(a);
+}
+
 template <typename T>
 Read<T> Mesh::sync_subset_array(
     Int ent_dim, Read<T> a_data, LOs a2e, T default_val, Int width) {
@@ -555,8 +738,8 @@ Read<T> Mesh::reduce_array(Int ent_dim, Read<T> a, Int width, Omega_h_Op op) {
 template <typename T>
 Read<T> Mesh::owned_array(Int ent_dim, Read<T> a, Int width) {
   if (!could_be_shared(ent_dim)) return a;
-  auto o = owned(ent_dim);
-  auto o2e = collect_marked(o);
+  auto ranks = ask_owners(ent_dim).ranks;
+  auto o2e = collect_marked(pack_bits(lazy(ranks) == comm_->rank()));
   return unmap(o2e, a, width);
 }
 
@@ -663,6 +846,10 @@ void Mesh::set_rib_hints(RibPtr hints) { rib_hints_ = hints; }
       Int xfer, Int outflags, Read<T> array, bool internal);                   \
   template void Mesh::set_tag(                                                 \
       Int dim, std::string const& name, Read<T> array, bool internal);         \
+  template bool Mesh::has_tag(Int dim, TagHandle<T> tag) const;                \
+  template Read<T> Mesh::get_array(Int dim, TagHandle<T> tag) const;           \
+  template void Mesh::set_tag(                                                 \
+      Int dim, TagHandle<T> tag, Read<T> array, bool internal);                \
   template Read<T> Mesh::sync_array(Int ent_dim, Read<T> a, Int width);        \
   template Read<T> Mesh::owned_array(Int ent_dim, Read<T> a, Int width);       \
   template Read<T> Mesh::sync_subset_array(                                    \
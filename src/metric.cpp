@@ -27,6 +27,61 @@ static Reals mident_metrics_tmpl(Mesh* mesh, LOs a2e, Reals v2m) {
   return out;
 }
 
+template <Int dim>
+static SymmDecomps decompose_symms_dim(Reals symms) {
+  auto n = symms.size() / symm_dofs(dim);
+  auto q = Write<Real>(n * square(dim));
+  auto l = Write<Real>(n * dim);
+  auto f = LAMBDA(LO i) {
+    auto decomp = decompose_symm(get_symm<dim>(symms, i));
+    set_matrix(q, i, decomp.q);
+    set_vector(l, i, decomp.l);
+  };
+  parallel_for(n, f);
+  return {q, l};
+}
+
+SymmDecomps decompose_symms(Int dim, Reals symms) {
+  CHECK(symms.size() % symm_dofs(dim) == 0);
+  if (dim == 3) return decompose_symms_dim<3>(symms);
+  if (dim == 2) return decompose_symms_dim<2>(symms);
+  NORETURN(SymmDecomps());
+}
+
+template <Int dim>
+static Reals invert_symms_dim(Reals symms) {
+  auto n = symms.size() / symm_dofs(dim);
+  auto out = Write<Real>(n * symm_dofs(dim));
+  auto f = LAMBDA(LO i) {
+    set_symm(out, i, invert_symm(get_symm<dim>(symms, i)));
+  };
+  parallel_for(n, f);
+  return out;
+}
+
+Reals invert_symms(Int dim, Reals symms) {
+  CHECK(symms.size() % symm_dofs(dim) == 0);
+  if (dim == 3) return invert_symms_dim<3>(symms);
+  if (dim == 2) return invert_symms_dim<2>(symms);
+  NORETURN(Reals());
+}
+
+template <Int dim>
+static Reals symm_determinants_dim(Reals symms) {
+  auto n = symms.size() / symm_dofs(dim);
+  auto out = Write<Real>(n);
+  auto f = LAMBDA(LO i) { out[i] = determinant(get_symm<dim>(symms, i)); };
+  parallel_for(n, f);
+  return out;
+}
+
+Reals symm_determinants(Int dim, Reals symms) {
+  CHECK(symms.size() % symm_dofs(dim) == 0);
+  if (dim == 3) return symm_determinants_dim<3>(symms);
+  if (dim == 2) return symm_determinants_dim<2>(symms);
+  NORETURN(Reals());
+}
+
 Reals get_mident_metrics(Mesh* mesh, Int ent_dim, LOs entities, Reals v2m) {
   if (mesh->dim() == 3 && ent_dim == 3) {
     return mident_metrics_tmpl<3, 3>(mesh, entities, v2m);
@@ -138,7 +193,7 @@ void axes_from_metric_field(Mesh* mesh, std::string const& metric_name,
 template <Int dim>
 static INLINE Matrix<dim, dim> metric_from_hessian(
     Matrix<dim, dim> hessian, Real eps, Real hmin, Real hmax) {
-  auto ed = decompose_eigen(hessian);
+  auto ed = decompose_symm(hessian);
   auto r = ed.q;
   auto l = ed.l;
   constexpr auto c_num = square(dim);
@@ -148,7 +203,7 @@ static INLINE Matrix<dim, dim> metric_from_hessian(
     auto val = (c_num * fabs(l[i])) / (c_denom * eps);
     tilde_l[i] = min2(max2(val, 1. / square(hmax)), 1. / square(hmin));
   }
-  return compose_eigen(r, tilde_l);
+  return compose_ortho(r, tilde_l);
 }
 
 template <Int dim>
@@ -205,26 +260,24 @@ Reals metric_for_nelems_from_hessians(Mesh* mesh, Real target_nelems,
 
 template <Int dim>
 static INLINE Matrix<dim, dim> form_limiting_metric(
-    Matrix<dim, dim> m, Real real_dist, Real log_rate) {
-  auto decomp = decompose_eigen(m);
+    Matrix<dim, dim> q, Vector<dim> l, Real real_dist, Real log_rate) {
   for (Int i = 0; i < dim; ++i) {
-    decomp.l[i] /= square(1 + decomp.l[i] * real_dist * log_rate);
+    l[i] /= square(1 + l[i] * real_dist * log_rate);
   }
-  return compose_ortho(decomp.q, decomp.l);
-}
-
-template <Int dim>
-static INLINE Matrix<dim, dim> limit_metric_by_adj(Matrix<dim, dim> m,
-    Vector<dim> x, Matrix<dim, dim> am, Vector<dim> ax, Real log_rate) {
-  auto limit_m = form_limiting_metric(am, norm(ax - x), log_rate);
-  return intersect_metrics(m, limit_m);
+  return compose_ortho(q, l);
 }
 
+/* each vertex metric is decomposed once per iteration
+   and reused by all of its neighbors, rather than being
+   decomposed again for every adjacency that reads it */
 template <Int dim>
 static Reals limit_metrics_once_by_adj_dim(
     Mesh* mesh, Reals metrics, Real max_rate) {
   auto v2v = mesh->ask_star(VERT);
   auto coords = mesh->coords();
+  auto decomps = decompose_symms(dim, metrics);
+  auto qs = decomps.q;
+  auto ls = decomps.l;
   auto out = Write<Real>(mesh->nverts() * symm_dofs(dim));
   auto log_rate = ::log(max_rate);
   auto f = LAMBDA(LO v) {
@@ -232,9 +285,11 @@ static Reals limit_metrics_once_by_adj_dim(
     auto x = get_vector<dim>(coords, v);
     for (auto vv = v2v.a2ab[v]; vv < v2v.a2ab[v + 1]; ++vv) {
       auto av = v2v.ab2b[vv];
-      auto am = get_symm<dim>(metrics, av);
+      auto aq = get_matrix<dim>(qs, av);
+      auto al = get_vector<dim>(ls, av);
       auto ax = get_vector<dim>(coords, av);
-      m = limit_metric_by_adj(m, x, am, ax, log_rate);
+      auto limit_m = form_limiting_metric(aq, al, norm(ax - x), log_rate);
+      m = intersect_metrics(m, limit_m);
     }
     set_symm(out, v, m);
   };
@@ -30,7 +30,7 @@ INLINE Vector<dim> metric_lengths(Vector<dim> l) {
 
 template <Int dim>
 INLINE Decomposition<dim> decompose_metric(Matrix<dim, dim> m) {
-  auto ed = decompose_eigen(m);
+  auto ed = decompose_symm(m);
   auto h = metric_lengths(ed.l);
   return {ed.q, h};
 }
@@ -60,7 +60,7 @@ https://www.rocq.inria.fr/gamma/Frederic.Alauzet/
 template <Int dim>
 INLINE Matrix<dim, dim> intersect_metrics(
     Matrix<dim, dim> m1, Matrix<dim, dim> m2) {
-  auto n = invert(m1) * m2;
+  auto n = invert_symm(m1) * m2;
   auto n_decomp = decompose_eigen(n);
   bool all_above_one = true;
   bool all_below_one = true;
@@ -166,6 +166,18 @@ INLINE Matrix<dim, dim> maxdet_metric(Few<Matrix<dim, dim>, n> ms) {
   return m;
 }
 
+/* eigendecompositions of an array of symmetric tensors
+   (symm_dofs(dim) components each), via decompose_symm().
+   (q) holds dim*dim components per tensor, (l) holds dim. */
+struct SymmDecomps {
+  Reals q;
+  Reals l;
+};
+
+SymmDecomps decompose_symms(Int dim, Reals symms);
+Reals invert_symms(Int dim, Reals symms);
+Reals symm_determinants(Int dim, Reals symms);
+
 Reals get_mident_metrics(Mesh* mesh, Int ent_dim, LOs entities, Reals v2m);
 Reals interpolate_between_metrics(Int dim, Reals a, Reals b, Real t);
 Reals linearize_metrics(Int dim, Reals metrics);
@@ -156,6 +156,10 @@ void push_ents(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
   new_mesh->set_owners(ent_dim, owners);
 }
 
+static std::size_t nmigrations = 0;
+
+std::size_t get_nmigrations() { return nmigrations; }
+
 static void print_migrate_stats(CommPtr comm, Dist new_elems2old_owners) {
   auto msgs2ranks = new_elems2old_owners.msgs2ranks();
   auto msgs2content = new_elems2old_owners.msgs2content();
@@ -182,6 +186,7 @@ void migrate_mesh(Mesh* old_mesh, Mesh* new_mesh, Dist new_elems2old_owners,
     Omega_h_Parting mode, bool verbose) {
   auto comm = old_mesh->comm();
   auto dim = old_mesh->dim();
+  ++nmigrations;
   if (verbose) print_migrate_stats(comm, new_elems2old_owners);
   Dist new_ents2old_owners = new_elems2old_owners;
   auto old_owners2new_ents = new_ents2old_owners.invert();
@@ -39,6 +39,10 @@ void migrate_mesh(Mesh* old_mesh, Mesh* new_mesh, Dist new_elems2old_owners,
 void migrate_mesh(Mesh* mesh, Dist new_elems2old_owners, bool verbose);
 void migrate_mesh(Mesh* mesh, Remotes new_elems2old_owners, bool verbose);
 
+/* total calls to migrate_mesh(), including those that ghost
+   or partition by vertices */
+std::size_t get_nmigrations();
+
 }  // end namespace Omega_h
 
 #endif
@@ -1,6 +1,7 @@
 #include "modify.hpp"
 
 #include "adjacency.hpp"
+#include "align.hpp"
 #include "array.hpp"
 #include "atomics.hpp"
 #include "linpart.hpp"
@@ -22,10 +23,7 @@ static void modify_conn(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
   auto down_degree = simplex_degrees[ent_dim][low_dim];
   auto old_ents2old_lows = old_mesh->ask_down(ent_dim, low_dim);
   auto old_ent_lows2old_lows = old_ents2old_lows.ab2b;
-  auto same_ent_lows2old_lows =
-      unmap(same_ents2old_ents, old_ent_lows2old_lows, down_degree);
-  auto same_ent_lows2new_lows =
-      compound_maps(same_ent_lows2old_lows, old_lows2new_lows);
+  auto old_ent_low_codes = old_ents2old_lows.codes;
   auto prods2new_lows = Adj();
   if (low_dim > VERT) {
     auto new_low_verts2new_verts = new_mesh->ask_verts_of(low_dim);
@@ -37,25 +35,36 @@ static void modify_conn(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
   }
   auto prod_lows2new_lows = prods2new_lows.ab2b;
   auto nsame_ents = same_ents2old_ents.size();
+  CHECK(nsame_ents == same_ents2new_ents.size());
   auto nprods = prods2new_ents.size();
   auto nnew_ents = nsame_ents + nprods;
+  auto has_codes = (low_dim > VERT);
   Write<LO> new_ent_lows2new_lows(nnew_ents * down_degree);
-  auto new_ent_low_codes = Write<I8>();
+  auto new_ent_low_codes =
+      has_codes ? Write<I8>(nnew_ents * down_degree) : Write<I8>();
   map_into(
       prod_lows2new_lows, prods2new_ents, new_ent_lows2new_lows, down_degree);
-  map_into(same_ent_lows2new_lows, same_ents2new_ents, new_ent_lows2new_lows,
-      down_degree);
-  if (low_dim > VERT) {
-    new_ent_low_codes = Write<I8>(nnew_ents * down_degree);
-    auto old_ent_low_codes = old_ents2old_lows.codes;
-    CHECK(same_ents2old_ents.size() == same_ents2new_ents.size());
-    auto same_ent_low_codes =
-        unmap(same_ents2old_ents, old_ent_low_codes, down_degree);
-    map_into(
-        same_ent_low_codes, same_ents2new_ents, new_ent_low_codes, down_degree);
-    auto prod_low_codes = prods2new_lows.codes;
-    map_into(prod_low_codes, prods2new_ents, new_ent_low_codes, down_degree);
+  if (has_codes) {
+    map_into(prods2new_lows.codes, prods2new_ents, new_ent_low_codes,
+        down_degree);
   }
+  /* entities away from the cavities are carried over in one pass,
+     renumbering their lower entities on the way, rather than
+     going through whole-mesh temporary arrays */
+  auto carry_same = LAMBDA(LO same_ent) {
+    auto old_ent = same_ents2old_ents[same_ent];
+    auto new_ent = same_ents2new_ents[same_ent];
+    for (Int i = 0; i < down_degree; ++i) {
+      auto old_low = old_ent_lows2old_lows[old_ent * down_degree + i];
+      new_ent_lows2new_lows[new_ent * down_degree + i] =
+          old_lows2new_lows[old_low];
+      if (has_codes) {
+        new_ent_low_codes[new_ent * down_degree + i] =
+            old_ent_low_codes[old_ent * down_degree + i];
+      }
+    }
+  };
+  parallel_for(nsame_ents, carry_same);
   auto new_ents2new_lows =
       Adj(LOs(new_ent_lows2new_lows), Read<I8>(new_ent_low_codes));
   new_mesh->set_ents(ent_dim, new_ents2new_lows);
@@ -97,8 +106,8 @@ static LOs collect_same(Mesh* mesh, Int ent_dim, Int key_dim, LOs keys2kds) {
     CHECK(ent_dim > key_dim);
     ents_are_adj = mark_up(mesh, key_dim, ent_dim, kds_are_keys);
   }
-  auto ents_not_adj = invert_marks(ents_are_adj);
-  return collect_marked(ents_not_adj);
+  auto is_same = LAMBDA(LO ent) { return !ents_are_adj[ent]; };
+  return collect_if(ents_are_adj.size(), is_same);
 }
 
 static LOs get_keys2reps(
@@ -254,6 +263,30 @@ static void find_new_offsets(Read<T> old_ents2new_offsets,
   *p_prods2new_offsets = prods2new_offsets_w;
 }
 
+/* on a single rank the linear partition of the global numbers is
+   the global numbering itself, so the representative counts can be
+   scattered by global number and scanned directly, which is what
+   the Dist-based path below computes, minus the two sorts that
+   building a Dist costs */
+static Read<GO> get_new_rep_globals_serial(
+    CommPtr comm, Read<GO> old_globals, LOs global_rep_counts) {
+  CHECK(comm->size() == 1);
+  auto nents = old_globals.size();
+  auto nlins = static_cast<LO>(find_total_globals(comm, old_globals));
+  Write<LO> lin_rep_counts(nlins, 0);
+  auto scatter = LAMBDA(LO ent) {
+    lin_rep_counts[static_cast<LO>(old_globals[ent])] = global_rep_counts[ent];
+  };
+  parallel_for(nents, scatter);
+  auto lin_offsets = offset_scan(LOs(lin_rep_counts));
+  Write<GO> old_ents2new_globals(nents);
+  auto gather = LAMBDA(LO ent) {
+    old_ents2new_globals[ent] = lin_offsets[static_cast<LO>(old_globals[ent])];
+  };
+  parallel_for(nents, gather);
+  return old_ents2new_globals;
+}
+
 static void modify_globals(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
     Int key_dim, LOs keys2kds, LOs keys2prods, LOs prods2new_ents,
     LOs same_ents2old_ents, LOs same_ents2new_ents, LOs keys2reps,
@@ -267,21 +300,28 @@ static void modify_globals(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
   CHECK(nprods == keys2prods.last());
   auto old_globals = old_mesh->ask_globals(ent_dim);
   auto comm = old_mesh->comm();
-  auto old_ents2lins = copies_to_linear_owners(comm, old_globals);
-  auto lins2old_ents = old_ents2lins.invert();
-  auto nlins = lins2old_ents.nroots();
-  auto lin_rep_counts =
-      old_ents2lins.exch_reduce(global_rep_counts, 1, OMEGA_H_SUM);
-  CHECK(lin_rep_counts.size() == nlins);
-  auto lin_local_offsets = offset_scan(lin_rep_counts);
-  auto lin_global_count = lin_local_offsets.last();
-  GO lin_global_offset = comm->exscan<GO>(GO(lin_global_count), OMEGA_H_SUM);
-  Write<GO> lin_globals(nlins);
-  auto write_lin_globals = LAMBDA(LO lin) {
-    lin_globals[lin] = lin_local_offsets[lin] + lin_global_offset;
-  };
-  parallel_for(nlins, write_lin_globals);
-  auto old_ents2new_globals = lins2old_ents.exch(Read<GO>(lin_globals), 1);
+  Read<GO> old_ents2new_globals;
+  if (comm->size() == 1) {
+    old_ents2new_globals =
+        get_new_rep_globals_serial(comm, old_globals, global_rep_counts);
+  } else {
+    auto old_ents2lins = copies_to_linear_owners(comm, old_globals);
+    auto lins2old_ents = old_ents2lins.invert();
+    auto nlins = lins2old_ents.nroots();
+    auto lin_rep_counts =
+        old_ents2lins.exch_reduce(global_rep_counts, 1, OMEGA_H_SUM);
+    CHECK(lin_rep_counts.size() == nlins);
+    auto lin_local_offsets = offset_scan(lin_rep_counts);
+    auto lin_global_count = lin_local_offsets.last();
+    GO lin_global_offset =
+        comm->exscan<GO>(GO(lin_global_count), OMEGA_H_SUM);
+    Write<GO> lin_globals(nlins);
+    auto write_lin_globals = LAMBDA(LO lin) {
+      lin_globals[lin] = lin_local_offsets[lin] + lin_global_offset;
+    };
+    parallel_for(nlins, write_lin_globals);
+    old_ents2new_globals = lins2old_ents.exch(Read<GO>(lin_globals), 1);
+  }
   Read<GO> same_ents2new_globals;
   Read<GO> prods2new_globals;
   auto edge2rep_order = LOs();
@@ -304,6 +344,7 @@ void modify_ents(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim, Int key_dim,
     LOs keys2kds, LOs keys2prods, LOs prod_verts2verts, LOs old_lows2new_lows,
     LOs* p_prods2new_ents, LOs* p_same_ents2old_ents, LOs* p_same_ents2new_ents,
     LOs* p_old_ents2new_ents) {
+  profile::Region region("modify_ents");
   *p_same_ents2old_ents = collect_same(old_mesh, ent_dim, key_dim, keys2kds);
   auto nkeys = keys2kds.size();
   CHECK(nkeys == keys2prods.size() - 1);
@@ -348,6 +389,99 @@ void modify_ents(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim, Int key_dim,
   }
 }
 
+/* builds the new (low_dim -> ent_dim) upward adjacency from the old one
+   instead of inverting the new downward adjacency.
+   the uses of a kept low by kept entities are the old uses, renumbered,
+   and the rest are uses by products, which are appended and then
+   merged in by global number.
+   the result is identical to what invert_adj() would compute. */
+
+static Adj modify_up_adj(Mesh* old_mesh, Mesh* new_mesh, Int low_dim,
+    Int ent_dim, LOs old_lows2new_lows, LOs old_ents2new_ents,
+    LOs prods2new_ents) {
+  auto old_l2h = old_mesh->ask_up(low_dim, ent_dim);
+  auto old_l2lh = old_l2h.a2ab;
+  auto old_lh2h = old_l2h.ab2b;
+  auto old_codes = old_l2h.codes;
+  auto new_h2l = new_mesh->ask_down(ent_dim, low_dim);
+  auto new_hl2l = new_h2l.ab2b;
+  auto new_down_codes = new_h2l.codes;
+  auto has_codes = new_down_codes.exists();
+  auto deg = simplex_degrees[ent_dim][low_dim];
+  auto nold_lows = old_mesh->nents(low_dim);
+  auto nnew_lows = new_mesh->nents(low_dim);
+  auto nnew_lh = new_mesh->nents(ent_dim) * deg;
+  auto nprods = prods2new_ents.size();
+  Write<LO> degrees(nnew_lows, 0);
+  auto count_same = LAMBDA(LO old_low) {
+    auto new_low = old_lows2new_lows[old_low];
+    if (new_low < 0) return;
+    LO n = 0;
+    for (auto lh = old_l2lh[old_low]; lh < old_l2lh[old_low + 1]; ++lh) {
+      if (old_ents2new_ents[old_lh2h[lh]] >= 0) ++n;
+    }
+    degrees[new_low] = n;
+  };
+  parallel_for(nold_lows, count_same);
+  auto nsame_uses = deep_copy(Read<LO>(degrees));
+  auto count_prods = LAMBDA(LO prod) {
+    auto h = prods2new_ents[prod];
+    for (Int j = 0; j < deg; ++j) {
+      atomic_increment(&degrees[new_hl2l[h * deg + j]]);
+    }
+  };
+  parallel_for(nprods, count_prods);
+  auto l2lh = offset_scan(Read<LO>(degrees));
+  CHECK(l2lh.last() == nnew_lh);
+  Write<LO> lh2h(nnew_lh);
+  Write<I8> codes(nnew_lh);
+  auto fill_same = LAMBDA(LO old_low) {
+    auto new_low = old_lows2new_lows[old_low];
+    if (new_low < 0) return;
+    auto new_lh = l2lh[new_low];
+    for (auto lh = old_l2lh[old_low]; lh < old_l2lh[old_low + 1]; ++lh) {
+      auto new_h = old_ents2new_ents[old_lh2h[lh]];
+      if (new_h < 0) continue;
+      lh2h[new_lh] = new_h;
+      codes[new_lh] = old_codes[lh];
+      ++new_lh;
+    }
+  };
+  parallel_for(nold_lows, fill_same);
+  auto fill_prods = LAMBDA(LO prod) {
+    auto h = prods2new_ents[prod];
+    for (Int j = 0; j < deg; ++j) {
+      auto hl = h * deg + j;
+      auto l = new_hl2l[hl];
+      auto lh = l2lh[l] + atomic_fetch_add<LO>(&nsame_uses[l], 1);
+      lh2h[lh] = h;
+      if (has_codes) {
+        auto dc = new_down_codes[hl];
+        codes[lh] = make_code(code_is_flipped(dc), code_rotation(dc), j);
+      } else {
+        codes[lh] = make_code(false, 0, j);
+      }
+    }
+  };
+  parallel_for(nprods, fill_prods);
+  order_by_globals(l2lh, lh2h, codes, new_mesh->ask_globals(ent_dim));
+  return Adj(l2lh, lh2h, codes);
+}
+
+void modify_up_adjs(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    HostFew<LOs, 4> const& old_ents2new_ents, LOs prods2new_ents) {
+  profile::Region region("modify_up_adjs");
+  for (Int low_dim = 0; low_dim < ent_dim; ++low_dim) {
+    if (!old_mesh->has_adj(low_dim, ent_dim)) continue;
+    if (!old_mesh->adj_was_used(low_dim, ent_dim)) continue;
+    if (new_mesh->has_adj(low_dim, ent_dim)) continue;
+    auto adj = modify_up_adj(old_mesh, new_mesh, low_dim, ent_dim,
+        old_ents2new_ents[low_dim], old_ents2new_ents[ent_dim],
+        prods2new_ents);
+    new_mesh->add_up(low_dim, ent_dim, adj);
+  }
+}
+
 void set_owners_by_indset(
     Mesh* mesh, Int key_dim, LOs keys2kds, Graph kds2elems) {
   auto kd_owners = mesh->ask_owners(key_dim);
@@ -1,6 +1,7 @@
 #ifndef MODIFY_HPP
 #define MODIFY_HPP
 
+#include "host_few.hpp"
 #include "internal.hpp"
 
 namespace Omega_h {
@@ -12,6 +13,13 @@ void modify_ents(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim, Int key_dim,
     LOs* p_prods2new_ents, LOs* p_same_ents2old_ents, LOs* p_same_ents2new_ents,
     LOs* p_old_ents2new_ents);
 
+/* carries over to (new_mesh) each upward adjacency into (ent_dim)
+   that (old_mesh) has and was asked for, so that it need not be
+   re-derived by inversion.
+   (old_ents2new_ents) holds the maps of all dimensions up to (ent_dim). */
+void modify_up_adjs(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    HostFew<LOs, 4> const& old_ents2new_ents, LOs prods2new_ents);
+
 void set_owners_by_indset(
     Mesh* mesh, Int key_dim, LOs keys2kds, Graph kds2elems);
 
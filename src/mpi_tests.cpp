@@ -207,6 +207,51 @@ static void test_read_vtu(Library* lib, CommPtr comm) {
   CHECK(OMEGA_H_SAME == compare_meshes(&mesh0, &mesh1, 0.0, 0.0, true, false));
 }
 
+static void test_unghost(Library* lib, CommPtr comm) {
+  Mesh mesh(lib);
+  if (comm->rank() == 0) {
+    build_box(&mesh, 1, 1, 1, 3, 3, 3);
+    classify_by_angles(&mesh, PI / 4);
+  }
+  mesh.set_comm(comm);
+  mesh.balance();
+  auto elem_based = mesh;
+  mesh.set_parting(OMEGA_H_GHOSTED, 3, false);
+  auto thick = mesh;
+  mesh.set_parting(OMEGA_H_GHOSTED, 1, false);
+  CHECK(mesh.nelems() < thick.nelems());
+  auto thin = elem_based;
+  thin.set_parting(OMEGA_H_GHOSTED, 1, false);
+  CHECK(mesh.nelems() == thin.nelems());
+  CHECK(OMEGA_H_SAME == compare_meshes(&mesh, &thin, 0.0, 0.0, true, true));
+  mesh.set_parting(OMEGA_H_ELEM_BASED);
+  CHECK(mesh.nelems() == elem_based.nelems());
+  CHECK(OMEGA_H_SAME ==
+        compare_meshes(&mesh, &elem_based, 0.0, 0.0, true, true));
+  for (Int dim = 0; dim <= mesh.dim(); ++dim) {
+    CHECK(sum(mesh.owned(dim)) == sum(elem_based.owned(dim)));
+  }
+}
+
+static void test_predictive_balance(Library* lib, CommPtr comm) {
+  Mesh mesh(lib);
+  if (comm->rank() == 0) {
+    build_box(&mesh, 1, 1, 1, 2, 2, 2);
+    classify_by_angles(&mesh, PI / 4);
+  }
+  mesh.set_comm(comm);
+  mesh.add_tag(VERT, "size", 1, OMEGA_H_SIZE, OMEGA_H_DO_OUTPUT,
+      Reals(mesh.nverts(), 0.3));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.max_predicted_imbalance = 1.5;
+  AdaptStats stats;
+  CHECK(adapt(&mesh, opts, &stats));
+  CHECK(stats.balanced);
+  CHECK(stats.predicted_imbalance > 1.5);
+  CHECK(comm->allreduce(GO(mesh.nelems() > 0), OMEGA_H_SUM) == 2);
+}
+
 static void test_two_ranks(Library* lib, CommPtr comm) {
   test_two_ranks_dist(comm);
   test_two_ranks_owners(comm);
@@ -215,6 +260,8 @@ static void test_two_ranks(Library* lib, CommPtr comm) {
   test_resolve_derived(comm);
   test_construct(lib, comm);
   test_read_vtu(lib, comm);
+  test_unghost(lib, comm);
+  test_predictive_balance(lib, comm);
 }
 
 static void test_rib(CommPtr comm) {
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <iostream>
 #include <random>
+#include <vector>
 
 #include "access.hpp"
 #include "adjacency.hpp"
@@ -10,14 +11,43 @@
 #include "internal.hpp"
 #include "loop.hpp"
 #include "metric.hpp"
+#include "quality.hpp"
 #include "sort.hpp"
 #include "space.hpp"
+#include "threads.hpp"
 #include "timer.hpp"
 
 using namespace Omega_h;
 
 static Int const nelems = 1000 * 1000;
 
+/* perf_tests may run all its kernels several times, first with one
+   thread. the (i)th timing of each later run is printed along with
+   its speedup over the (i)th timing of the first run */
+static std::vector<Real> first_run_seconds;
+static std::size_t ntimings = 0;
+
+struct Took {
+  Real seconds;
+  Real speedup;
+};
+
+static Took took(Now t0, Now t1) {
+  auto seconds = t1 - t0;
+  auto i = ntimings++;
+  if (i == first_run_seconds.size()) {
+    first_run_seconds.push_back(seconds);
+    return Took{seconds, 0.0};
+  }
+  return Took{seconds, first_run_seconds[i] / seconds};
+}
+
+static std::ostream& operator<<(std::ostream& os, Took const& t) {
+  os << t.seconds << " seconds";
+  if (t.speedup > 0.0) os << " (" << t.speedup << "x over 1 thread)";
+  return os;
+}
+
 /* Intel compiler version 16 doesn't seem to have
  * std::uniform_real_distribution and std::uniform_int_distribution */
 #ifndef __INTEL_COMPILER
@@ -67,8 +97,29 @@ static void test_metric_decompose(Reals metrics) {
   for (Int i = 0; i < niters; ++i) parallel_for(nelems, f1);
   Now t1 = now();
   std::cout << "eigendecomposition of " << nelems << " metric tensors "
-            << niters << " times takes " << (t1 - t0) << " seconds\n";
+            << niters << " times takes " << took(t0, t1) << "\n";
   CHECK(are_close(Reals(write_eigenvs), Reals(nelems, square(anisotropy))));
+  auto f2 = LAMBDA(Int i) {
+    auto m = get_symm<3>(metrics, i);
+    auto l = decompose_symm(m).l;
+    auto eigenv = max2(max2(l[0], l[1]), l[2]);
+    write_eigenvs[i] = eigenv;
+  };
+  t0 = now();
+  for (Int i = 0; i < niters; ++i) parallel_for(nelems, f2);
+  t1 = now();
+  std::cout << "symmetric eigendecomposition of " << nelems
+            << " metric tensors " << niters << " times takes " << took(t0, t1)
+            << "\n";
+  CHECK(are_close(Reals(write_eigenvs), Reals(nelems, square(anisotropy))));
+  SymmDecomps decomps;
+  t0 = now();
+  for (Int i = 0; i < niters; ++i) decomps = decompose_symms(3, metrics);
+  t1 = now();
+  std::cout << "batched symmetric eigendecomposition of " << nelems
+            << " metric tensors " << niters << " times takes " << took(t0, t1)
+            << "\n";
+  CHECK(decomps.l.size() == nelems * 3);
 }
 
 static void test_metric_invert(Reals metrics) {
@@ -85,7 +136,15 @@ static void test_metric_invert(Reals metrics) {
   for (Int i = 0; i < niters; ++i) parallel_for(nelems, f1);
   Now t1 = now();
   std::cout << "inversion of " << nelems << " metric tensors " << niters
-            << " times takes " << (t1 - t0) << " seconds\n";
+            << " times takes " << took(t0, t1) << "\n";
+  Reals invs;
+  t0 = now();
+  for (Int i = 0; i < niters; ++i) invs = invert_symms(3, metrics);
+  t1 = now();
+  std::cout << "batched symmetric inversion of " << nelems
+            << " metric tensors " << niters << " times takes " << took(t0, t1)
+            << "\n";
+  CHECK(invs.size() == metrics.size());
 }
 
 static void test_metric_math() {
@@ -121,14 +180,14 @@ static void test_repro_sum() {
     Now t1 = now();
     std::cout << "reproducibly adding " << nelems << " reals " << niters
               << " times "
-              << "takes " << (t1 - t0) << " seconds\n";
+              << "takes " << took(t0, t1) << "\n";
   }
   {
     Now t0 = now();
     for (Int i = 0; i < niters; ++i) s = sum(inputs);
     Now t1 = now();
     std::cout << "adding " << nelems << " reals " << niters << " times "
-              << "takes " << (t1 - t0) << " seconds\n";
+              << "takes " << took(t0, t1) << "\n";
   }
   CHECK(are_close(s, rs));
   Read<Int> p = random_perm(nelems);
@@ -158,10 +217,19 @@ static void test_sort_n(Int width) {
   LOs perm;
   Int niters = 5;
   Now t0 = now();
-  for (Int i = 0; i < niters; ++i) perm = sort_by_keys(a, width);
+  for (Int i = 0; i < niters; ++i) perm = comparison_sort_by_keys(a, width);
   Now t1 = now();
-  std::cout << "sorting " << nelems << " sets of " << width << " integers "
-            << niters << " times takes " << (t1 - t0) << " seconds\n";
+  std::cout << "comparison sorting " << nelems << " sets of " << width
+            << " integers " << niters << " times takes " << took(t0, t1)
+            << "\n";
+  LOs radix_perm;
+  t0 = now();
+  for (Int i = 0; i < niters; ++i) radix_perm = radix_sort_by_keys(a, width);
+  t1 = now();
+  std::cout << "radix sorting " << nelems << " sets of " << width
+            << " integers " << niters << " times takes " << took(t0, t1)
+            << "\n";
+  CHECK(radix_perm == perm);
 }
 
 static void test_sort() {
@@ -182,7 +250,34 @@ static void test_invert_adj(LOs tets2verts, LO nverts) {
     inv = invert_adj(Adj(tets2verts), 4, nverts, tet_globals);
   Now t1 = now();
   std::cout << "inverting " << ntets << " tets -> verts " << niters
-            << " times takes " << (t1 - t0) << " seconds\n";
+            << " times takes " << took(t0, t1) << "\n";
+}
+
+/* a "fan" of tets around a few hub vertices, numbered so that
+   each upward list comes out of the atomic inversion reversed */
+static void test_invert_adj_hubs() {
+  LO nhubs = 4;
+  LO ntets = 1000 * 1000;
+  LO nverts = nhubs + ntets + 2;
+  Write<LO> tv2v(ntets * 4);
+  Write<GO> tet_globals(ntets);
+  auto f = LAMBDA(LO t) {
+    tv2v[t * 4 + 0] = t % nhubs;
+    tv2v[t * 4 + 1] = nhubs + t;
+    tv2v[t * 4 + 2] = nhubs + t + 1;
+    tv2v[t * 4 + 3] = nhubs + t + 2;
+    tet_globals[t] = ntets - t;
+  };
+  parallel_for(ntets, f);
+  Adj inv;
+  Int niters = 5;
+  Now t0 = now();
+  for (Int i = 0; i < niters; ++i) {
+    inv = invert_adj(Adj(LOs(tv2v)), 4, nverts, Read<GO>(tet_globals));
+  }
+  Now t1 = now();
+  std::cout << "inverting " << ntets << " tets -> verts with " << nhubs
+            << " hubs " << niters << " times takes " << took(t0, t1) << "\n";
 }
 
 static void test_reflect_down(LOs tets2verts, LOs tris2verts, LO nverts) {
@@ -197,8 +292,8 @@ static void test_reflect_down(LOs tets2verts, LOs tris2verts, LO nverts) {
       reflect_down(tets2verts, tris2verts, verts2tris, 3, 2);
     Now t1 = now();
     std::cout << "reflect_down " << ntets << " tets -> tris "
-              << "by only upward " << niters << " times takes " << (t1 - t0)
-              << " seconds\n";
+              << "by only upward " << niters << " times takes " << took(t0, t1)
+              << "\n";
   }
 }
 
@@ -210,14 +305,14 @@ static void test_adjs(Library* lib) {
     build_box(&mesh, 1, 1, 1, nx, nx, nx);
     Now t1 = now();
     std::cout << "building a " << nx << 'x' << nx << 'x' << nx << " box took "
-              << (t1 - t0) << " seconds\n";
+              << took(t0, t1) << "\n";
   }
   {
     Now t0 = now();
     mesh.reorder();
     Now t1 = now();
     std::cout << "reordering a " << mesh.nelems() << " tet mesh took "
-              << (t1 - t0) << " seconds\n";
+              << took(t0, t1) << "\n";
   }
   LOs tets2verts;
   LOs tris2verts;
@@ -227,19 +322,151 @@ static void test_adjs(Library* lib) {
     tris2verts = mesh.ask_verts_of(TRI);
     Now t1 = now();
     std::cout << "asking tet->vert and tri->vert of a " << mesh.nelems()
-              << " tet mesh took " << (t1 - t0) << " seconds\n";
+              << " tet mesh took " << took(t0, t1) << "\n";
   }
   auto nverts = mesh.nverts();
   test_invert_adj(tets2verts, nverts);
+  test_invert_adj_hubs();
   test_reflect_down(tets2verts, tris2verts, nverts);
 }
 
-int main(int argc, char** argv) {
-  auto lib = Library(&argc, &argv);
+static void test_hashed_matching(Library* lib) {
+  for (Int hashed = 0; hashed < 2; ++hashed) {
+    enable_hashed_matching(hashed == 1);
+    Mesh mesh(lib);
+    auto nx = 42;
+    Now t0 = now();
+    build_box(&mesh, 1, 1, 1, nx, nx, nx);
+    Now t1 = now();
+    auto tets2verts = mesh.ask_verts_of(TET);
+    auto tris2verts = mesh.ask_verts_of(TRI);
+    Int niters = 2;
+    Now t2 = now();
+    for (Int i = 0; i < niters; ++i) {
+      reflect_down(tets2verts, tris2verts, mesh.nverts(), 3, 2);
+    }
+    Now t3 = now();
+    auto how = hashed ? "hashed" : "sorted";
+    std::cout << how << " matching builds a " << nx << "^3 box in "
+              << took(t0, t1) << " and does reflect_down " << niters
+              << " times in " << took(t2, t3) << "\n";
+  }
+  enable_hashed_matching(false);
+}
+
+/* the per-element formulation that MetricElementQualities replaced,
+   which gathers every vertex metric and takes (dim + 2) determinants */
+static Reals measure_qualities_by_gather(Mesh* mesh) {
+  auto coords = mesh->coords();
+  auto metrics = mesh->get_array<Real>(VERT, "metric");
+  auto ev2v = mesh->ask_elem_verts();
+  auto a2e = LOs(mesh->nelems(), 0, 1);
+  Write<Real> quals(mesh->nelems());
+  auto f = LAMBDA(LO a) {
+    auto v = gather_verts<4>(ev2v, a2e[a]);
+    auto p = gather_vectors<4, 3>(coords, v);
+    auto ms = gather_symms<4, 3>(metrics, v);
+    quals[a] = metric_element_quality(p, maxdet_metric(ms));
+  };
+  parallel_for(mesh->nelems(), f);
+  return quals;
+}
+
+/* a cavity-sized subset, measured with and without the up-front
+   vertex determinants */
+static Reals measure_some_qualities(
+    Mesh* mesh, LOs a2e, MetricElementQualities measurer) {
+  auto ev2v = mesh->ask_elem_verts();
+  Write<Real> quals(a2e.size());
+  auto f = LAMBDA(LO a) {
+    quals[a] = measurer.measure(gather_verts<4>(ev2v, a2e[a]));
+  };
+  parallel_for(a2e.size(), f);
+  return quals;
+}
+
+static void test_qualities(Library* lib) {
+  Mesh mesh(lib);
+  auto nx = 55;
+  build_box(&mesh, 1, 1, 1, nx, nx, nx);
+  auto coords = mesh.coords();
+  Write<Real> metrics(mesh.nverts() * 6);
+  auto f = LAMBDA(LO v) {
+    auto x = get_vector<3>(coords, v);
+    auto r = rotate(x[0], vector_3(0, 0, 1));
+    set_symm(metrics, v, compose_metric(r, vector_3(1, 1 + x[1], 1e-2)));
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.add_tag(VERT, "metric", 6, OMEGA_H_METRIC, OMEGA_H_DO_OUTPUT,
+      Reals(metrics));
+  Int niters = 10;
+  Reals quals;
+  Now t0 = now();
+  for (Int i = 0; i < niters; ++i) quals = measure_qualities_by_gather(&mesh);
+  Now t1 = now();
+  std::cout << "per-element gathered metric qualities of " << mesh.nelems()
+            << " tets " << niters << " times takes " << took(t0, t1) << "\n";
+  Reals quals2;
+  t0 = now();
+  for (Int i = 0; i < niters; ++i) quals2 = measure_qualities(&mesh);
+  t1 = now();
+  std::cout << "metric qualities of " << mesh.nelems() << " tets " << niters
+            << " times takes " << took(t0, t1) << "\n";
+  CHECK(quals2 == quals);
+  auto some = LOs(mesh.nelems() / 100, 0, 100);
+  auto dets = Reals();
+  Int nsome_iters = 100;
+  t0 = now();
+  for (Int i = 0; i < nsome_iters; ++i) {
+    dets = symm_determinants(3, mesh.get_array<Real>(VERT, "metric"));
+    quals = measure_some_qualities(
+        &mesh, some, MetricElementQualities(&mesh, dets));
+  }
+  t1 = now();
+  std::cout << "metric qualities of " << some.size() << " tets with all "
+            << "vertex determinants " << nsome_iters << " times takes "
+            << took(t0, t1) << "\n";
+  t0 = now();
+  for (Int i = 0; i < nsome_iters; ++i) {
+    quals2 = measure_some_qualities(&mesh, some, MetricElementQualities(&mesh));
+  }
+  t1 = now();
+  std::cout << "metric qualities of " << some.size() << " tets "
+            << nsome_iters << " times takes " << took(t0, t1) << "\n";
+  CHECK(quals2 == quals);
+  t0 = now();
+  for (Int i = 0; i < niters; ++i) measure_edges_metric(&mesh);
+  t1 = now();
+  std::cout << "metric lengths of " << mesh.nedges() << " edges " << niters
+            << " times takes " << took(t0, t1) << "\n";
+}
+
+static void run_kernels(Library* lib) {
+  ntimings = 0;
 #ifndef __INTEL_COMPILER
   test_metric_math();
   test_repro_sum();
   test_sort();
 #endif
-  test_adjs(&lib);
+  test_adjs(lib);
+  test_hashed_matching(lib);
+  test_qualities(lib);
+}
+
+int main(int argc, char** argv) {
+  auto lib = Library(&argc, &argv);
+#ifdef OMEGA_H_USE_THREADS
+  /* every kernel is timed with 1, 2, 4, ... threads, up to the
+     pool size chosen at startup (at least 2), by resizing the pool */
+  auto max_nthreads = max2(threads::nthreads(), Int(2));
+  for (Int nthreads = 1;; nthreads = min2(2 * nthreads, max_nthreads)) {
+    threads::finalize();
+    threads::init(nthreads);
+    std::cout << "using " << threads::nthreads() << " threads\n";
+    run_kernels(&lib);
+    if (nthreads == max_nthreads) break;
+  }
+#else
+  run_kernels(&lib);
+#endif
 }
@@ -0,0 +1,107 @@
+#include "pool.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Omega_h {
+
+/* size classes are 64 bytes and then four classes per
+   power of two, (5/4, 6/4, 7/4, 8/4) * 2^e, so rounding
+   never wastes more than a quarter of a block */
+enum { MIN_CLASS_BYTES = 64, NCLASSES = 1 + (64 - 6) * 4 };
+
+static std::size_t size_class(std::size_t bytes, Int* class_out) {
+  if (bytes <= MIN_CLASS_BYTES) {
+    *class_out = 0;
+    return MIN_CLASS_BYTES;
+  }
+  Int e = 63 - __builtin_clzll(static_cast<unsigned long long>(bytes - 1));
+  auto base = std::size_t(1) << e;
+  auto quarter = base >> 2;
+  auto k = (bytes - 1 - base) / quarter;
+  *class_out = 1 + (e - 6) * 4 + static_cast<Int>(k);
+  return base + (k + 1) * quarter;
+}
+
+/* (enabled) is read without the mutex so that allocations
+   skip locking entirely while pooling is off */
+struct Pool {
+  std::atomic<bool> enabled{false};
+  PoolStats stats = {0, 0, 0, 0};
+  std::vector<void*> free_lists[NCLASSES];
+  std::mutex mutex;
+};
+
+static Pool& get_pool() {
+  static Pool pool;
+  return pool;
+}
+
+void* pool_alloc(std::size_t bytes, bool* pooled) {
+  auto& pool = get_pool();
+  *pooled = false;
+  if (pool.enabled) {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    *pooled = pool.enabled;
+    if (*pooled) {
+      Int c;
+      bytes = size_class(bytes, &c);
+      ++pool.stats.nrequests;
+      auto& free_list = pool.free_lists[c];
+      if (!free_list.empty()) {
+        auto p = free_list.back();
+        free_list.pop_back();
+        ++pool.stats.nhits;
+        pool.stats.retained_bytes -= bytes;
+        return p;
+      }
+    }
+  }
+  return ::operator new(bytes);
+}
+
+void pool_free(void* p, std::size_t bytes, bool pooled) {
+  auto& pool = get_pool();
+  if (pooled && pool.enabled) {
+    Int c;
+    bytes = size_class(bytes, &c);
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.enabled) {
+      pool.free_lists[c].push_back(p);
+      pool.stats.retained_bytes += bytes;
+      pool.stats.max_retained_bytes =
+          max2(pool.stats.max_retained_bytes, pool.stats.retained_bytes);
+      return;
+    }
+  }
+  ::operator delete(p);
+}
+
+void enable_pooling(bool yn) {
+  auto& pool = get_pool();
+  pool.enabled = yn;
+  if (!yn) release_pooled_memory();
+}
+
+bool is_pooling_enabled() { return get_pool().enabled; }
+
+PoolStats get_pool_stats() {
+  auto& pool = get_pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  return pool.stats;
+}
+
+void release_pooled_memory() {
+  auto& pool = get_pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  for (auto& free_list : pool.free_lists) {
+    for (auto p : free_list) ::operator delete(p);
+    free_list.clear();
+    free_list.shrink_to_fit();
+  }
+  pool.stats.retained_bytes = 0;
+}
+
+}  // end namespace Omega_h
@@ -0,0 +1,18 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include "internal.hpp"
+
+namespace Omega_h {
+
+/* backing storage for Write<T> in builds without Kokkos.
+   when pooling is enabled, requests are rounded up to a size class
+   and served from that class's free list if possible.
+   (pooled) records which of the two paths a block took,
+   and must be passed back to pool_free() along with (bytes) */
+void* pool_alloc(std::size_t bytes, bool* pooled);
+void pool_free(void* p, std::size_t bytes, bool pooled);
+
+}  // end namespace Omega_h
+
+#endif
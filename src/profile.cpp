@@ -0,0 +1,181 @@
+#include "internal.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "memory.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
+
+namespace Omega_h {
+
+namespace profile {
+
+struct Node {
+  std::string name;
+  Int parent;
+  std::vector<Int> children;
+  I64 ncalls;
+  Real inclusive_time;
+  Real children_time;
+  std::size_t nbytes;
+};
+
+struct Frame {
+  Int node;
+  Now start_time;
+  std::size_t start_bytes;
+};
+
+struct Profiler {
+  bool is_enabled;
+  std::vector<Node> nodes;
+  std::vector<Frame> stack;
+  Profiler() : is_enabled(false) {
+    Node root;
+    root.parent = -1;
+    nodes.push_back(root);
+    zero_stats();
+  }
+  void zero_stats() {
+    for (auto& node : nodes) {
+      node.ncalls = 0;
+      node.inclusive_time = 0;
+      node.children_time = 0;
+      node.nbytes = 0;
+    }
+  }
+  Int current() const { return stack.empty() ? 0 : stack.back().node; }
+  Int find_child(char const* name) {
+    auto parent = current();
+    for (auto child : nodes[parent].children) {
+      if (nodes[child].name == name) return child;
+    }
+    Node node;
+    node.name = name;
+    node.parent = parent;
+    node.ncalls = 0;
+    node.inclusive_time = 0;
+    node.children_time = 0;
+    node.nbytes = 0;
+    auto child = static_cast<Int>(nodes.size());
+    nodes.push_back(node);
+    nodes[parent].children.push_back(child);
+    return child;
+  }
+};
+
+static Profiler& get_profiler() {
+  static Profiler profiler;
+  return profiler;
+}
+
+void enable(bool yn) { get_profiler().is_enabled = yn; }
+
+bool is_enabled() { return get_profiler().is_enabled; }
+
+void reset() { get_profiler().zero_stats(); }
+
+Region::Region(char const* name)
+    : is_active_(is_enabled()), is_traced_(tracing::recording) {
+  if (is_traced_) tracing::begin_region(name);
+  if (!is_active_) return;
+  auto& profiler = get_profiler();
+  Frame frame;
+  frame.node = profiler.find_child(name);
+  frame.start_bytes = get_allocated_bytes();
+  frame.start_time = now();
+  profiler.stack.push_back(frame);
+}
+
+Region::~Region() {
+  if (is_traced_) tracing::end_region();
+  if (!is_active_) return;
+  auto end_time = now();
+  auto& profiler = get_profiler();
+  auto frame = profiler.stack.back();
+  profiler.stack.pop_back();
+  auto& node = profiler.nodes[frame.node];
+  auto elapsed = end_time - frame.start_time;
+  ++node.ncalls;
+  node.inclusive_time += elapsed;
+  node.nbytes += get_allocated_bytes() - frame.start_bytes;
+  profiler.nodes[node.parent].children_time += elapsed;
+}
+
+static void list_paths(Profiler const& profiler, Int node,
+    std::string const& prefix, std::vector<std::string>* paths,
+    std::vector<Int>* nodes) {
+  for (auto child : profiler.nodes[node].children) {
+    auto path = prefix + '/' + profiler.nodes[child].name;
+    paths->push_back(path);
+    nodes->push_back(child);
+    list_paths(profiler, child, path, paths, nodes);
+  }
+}
+
+void print(CommPtr comm, std::ostream& stream) {
+  auto const& profiler = get_profiler();
+  std::vector<std::string> paths;
+  std::vector<Int> nodes;
+  list_paths(profiler, 0, "", &paths, &nodes);
+  std::map<std::string, Int> paths2nodes;
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    paths2nodes[paths[i]] = nodes[i];
+  }
+  std::string joined;
+  for (auto& path : paths) joined += path + '\n';
+  comm->bcast_string(joined);
+  std::stringstream joined_stream(joined);
+  std::string path;
+  std::ios::fmtflags stream_state(stream.flags());
+  auto precision_before = stream.precision();
+  if (comm->rank() == 0) {
+    stream << std::left << std::setw(40) << "region" << std::right
+           << std::setw(10) << "calls" << std::setw(12) << "incl min"
+           << std::setw(12) << "incl avg" << std::setw(12) << "incl max"
+           << std::setw(12) << "excl avg" << std::setw(12) << "MB avg"
+           << '\n';
+  }
+  auto nranks = Real(comm->size());
+  while (std::getline(joined_stream, path)) {
+    I64 ncalls = 0;
+    Real inclusive = 0;
+    Real exclusive = 0;
+    Real nbytes = 0;
+    auto it = paths2nodes.find(path);
+    if (it != paths2nodes.end()) {
+      auto& node = profiler.nodes[it->second];
+      ncalls = node.ncalls;
+      inclusive = node.inclusive_time;
+      exclusive = node.inclusive_time - node.children_time;
+      nbytes = Real(node.nbytes);
+    }
+    auto min_inclusive = comm->allreduce(inclusive, OMEGA_H_MIN);
+    auto max_inclusive = comm->allreduce(inclusive, OMEGA_H_MAX);
+    auto avg_inclusive = comm->allreduce(inclusive, OMEGA_H_SUM) / nranks;
+    auto avg_exclusive = comm->allreduce(exclusive, OMEGA_H_SUM) / nranks;
+    auto avg_nbytes = comm->allreduce(nbytes, OMEGA_H_SUM) / nranks;
+    auto total_ncalls = comm->allreduce(ncalls, OMEGA_H_SUM);
+    if (comm->rank() != 0) continue;
+    auto depth = std::count(path.begin(), path.end(), '/');
+    auto name = std::string(std::size_t(2 * (depth - 1)), ' ') +
+                path.substr(path.find_last_of('/') + 1);
+    stream << std::left << std::setw(40) << name << std::right
+           << std::setw(10) << total_ncalls << std::fixed
+           << std::setprecision(4) << std::setw(12) << min_inclusive
+           << std::setw(12) << avg_inclusive << std::setw(12)
+           << max_inclusive << std::setw(12) << avg_exclusive
+           << std::setprecision(1) << std::setw(12) << (avg_nbytes / 1e6)
+           << '\n';
+  }
+  stream.flags(stream_state);
+  stream.precision(precision_before);
+}
+
+}  // end namespace profile
+
+}  // end namespace Omega_h
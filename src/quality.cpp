@@ -9,14 +9,17 @@
 
 namespace Omega_h {
 
-template <typename ElementQualities, Int dim>
-Reals measure_qualities_tmpl(Mesh* mesh, LOs a2e) {
-  ElementQualities measurer(mesh);
+/* a null (a2e) means all elements, which saves building
+   and reading an identity map on every post_rebuild() */
+template <Int dim, typename ElementQualities>
+Reals measure_qualities_tmpl(
+    Mesh* mesh, LOs a2e, ElementQualities measurer) {
   auto ev2v = mesh->ask_verts_of(mesh->dim());
-  auto na = a2e.size();
+  auto all = !a2e.exists();
+  auto na = all ? mesh->nelems() : a2e.size();
   Write<Real> qualities(na);
   auto f = LAMBDA(LO a) {
-    auto e = a2e[a];
+    auto e = all ? a : a2e[a];
     auto v = gather_verts<dim + 1>(ev2v, e);
     qualities[a] = measurer.measure(v);
   };
@@ -24,25 +27,38 @@ Reals measure_qualities_tmpl(Mesh* mesh, LOs a2e) {
   return qualities;
 }
 
+/* every vertex is touched when measuring all elements, so the
+   vertex metric determinants are computed once up front */
+static MetricElementQualities get_metric_measurer(Mesh* mesh, LOs a2e) {
+  if (a2e.exists()) return MetricElementQualities(mesh);
+  auto metrics = mesh->get_array<Real>(VERT, "metric");
+  return MetricElementQualities(
+      mesh, symm_determinants(mesh->dim(), metrics));
+}
+
 Reals measure_qualities(Mesh* mesh, LOs a2e) {
   if (mesh->dim() == 3) {
     if (mesh->has_tag(VERT, "metric")) {
-      return measure_qualities_tmpl<MetricElementQualities, 3>(mesh, a2e);
+      return measure_qualities_tmpl<3>(
+          mesh, a2e, get_metric_measurer(mesh, a2e));
     } else {
-      return measure_qualities_tmpl<RealElementQualities, 3>(mesh, a2e);
+      return measure_qualities_tmpl<3>(
+          mesh, a2e, RealElementQualities(mesh));
     }
   } else {
     CHECK(mesh->dim() == 2);
     if (mesh->has_tag(VERT, "metric")) {
-      return measure_qualities_tmpl<MetricElementQualities, 2>(mesh, a2e);
+      return measure_qualities_tmpl<2>(
+          mesh, a2e, get_metric_measurer(mesh, a2e));
     } else {
-      return measure_qualities_tmpl<RealElementQualities, 2>(mesh, a2e);
+      return measure_qualities_tmpl<2>(
+          mesh, a2e, RealElementQualities(mesh));
     }
   }
 }
 
 Reals measure_qualities(Mesh* mesh) {
-  return measure_qualities(mesh, LOs(mesh->nelems(), 0, 1));
+  return measure_qualities(mesh, LOs());
 }
 
 }  // end namespace Omega_h
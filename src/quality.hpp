@@ -30,11 +30,6 @@ INLINE Real mean_ratio(Real size, Real mean_squared_length) {
   return power<2, dim>(size / equilateral_size<dim>()) / mean_squared_length;
 }
 
-template <Int dim>
-INLINE Real metric_size(Few<Vector<dim>, dim> basis, DummyIsoMetric) {
-  return element_size(basis);
-}
-
 /* This paper (and a few others):
  *
  * Loseille, Adrien, Victorien Menier, and Frederic Alauzet.
@@ -45,8 +40,15 @@ INLINE Real metric_size(Few<Vector<dim>, dim> basis, DummyIsoMetric) {
  */
 
 template <Int dim>
-INLINE Real metric_size(Few<Vector<dim>, dim> basis, Matrix<dim, dim> metric) {
-  return element_size(basis) * sqrt(determinant(metric));
+INLINE Real metric_size(Few<Vector<dim>, dim> basis, Real metric_det) {
+  return element_size(basis) * sqrt(metric_det);
+}
+
+INLINE Real metric_determinant(DummyIsoMetric) { return 1.0; }
+
+template <Int dim>
+INLINE Real metric_determinant(Matrix<dim, dim> metric) {
+  return determinant(metric);
 }
 
 /* note that we will always use a constant metric tensor over the whole
@@ -61,16 +63,24 @@ INLINE Real metric_size(Few<Vector<dim>, dim> basis, Matrix<dim, dim> metric) {
  * than 1.0, and other strange results.
  */
 
+/* (metric_det) is the determinant of (metric), for callers
+   that already have it */
 template <Int dim, typename Metric>
-INLINE Real metric_element_quality(Few<Vector<dim>, dim + 1> p, Metric metric) {
+INLINE Real metric_element_quality(
+    Few<Vector<dim>, dim + 1> p, Metric metric, Real metric_det) {
   auto b = simplex_basis<dim, dim>(p);
-  auto s = metric_size(b, metric);
+  auto s = metric_size(b, metric_det);
   if (s < 0) return s;
   auto ev = element_edge_vectors(p, b);
   auto msl = mean_squared_metric_length(ev, metric);
   return mean_ratio<dim>(s, msl);
 }
 
+template <Int dim, typename Metric>
+INLINE Real metric_element_quality(Few<Vector<dim>, dim + 1> p, Metric metric) {
+  return metric_element_quality(p, metric, metric_determinant(metric));
+}
+
 template <Int dim>
 INLINE Real real_element_quality(Few<Vector<dim>, dim + 1> p) {
   return metric_element_quality(p, DummyIsoMetric());
@@ -86,18 +96,51 @@ struct RealElementQualities {
   }
 };
 
+/* the metric of the vertex with the largest determinant is used
+   for the whole element (see maxdet_metric()), and that determinant
+   is reused for the metric volume.
+   the vertex determinants may be given up front (metric_dets), which
+   pays off when measuring every element; otherwise they are computed
+   per element, so measuring a few cavities costs nothing per vertex. */
 struct MetricElementQualities {
   Reals coords;
   Reals metrics;
+  Reals metric_dets;
   MetricElementQualities(Mesh const* mesh)
       : coords(mesh->coords()),
         metrics(mesh->get_array<Real>(VERT, "metric")) {}
+  MetricElementQualities(Mesh const* mesh, Reals metric_dets_in)
+      : coords(mesh->coords()),
+        metrics(mesh->get_array<Real>(VERT, "metric")),
+        metric_dets(metric_dets_in) {}
   template <Int neev>
   DEVICE Real measure(Few<LO, neev> v) const {
-    auto p = gather_vectors<neev, neev - 1>(coords, v);
-    auto ms = gather_symms<neev, neev - 1>(metrics, v);
-    auto m = maxdet_metric(ms);
-    return metric_element_quality(p, m);
+    constexpr Int dim = neev - 1;
+    auto p = gather_vectors<neev, dim>(coords, v);
+    if (metric_dets.exists()) {
+      auto maxdet_v = v[0];
+      auto maxdet = metric_dets[v[0]];
+      for (Int i = 1; i < neev; ++i) {
+        auto det = metric_dets[v[i]];
+        if (det > maxdet) {
+          maxdet_v = v[i];
+          maxdet = det;
+        }
+      }
+      return metric_element_quality(
+          p, get_symm<dim>(metrics, maxdet_v), maxdet);
+    }
+    auto m = get_symm<dim>(metrics, v[0]);
+    auto maxdet = determinant(m);
+    for (Int i = 1; i < neev; ++i) {
+      auto mi = get_symm<dim>(metrics, v[i]);
+      auto det = determinant(mi);
+      if (det > maxdet) {
+        m = mi;
+        maxdet = det;
+      }
+    }
+    return metric_element_quality(p, m, maxdet);
   }
 };
 
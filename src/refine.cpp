@@ -2,9 +2,12 @@
 
 #include <iostream>
 
+#include "adapt.hpp"
 #include "array.hpp"
+#include "expr.hpp"
 #include "indset.hpp"
 #include "map.hpp"
+#include "mark.hpp"
 #include "modify.hpp"
 #include "refine_qualities.hpp"
 #include "refine_topology.hpp"
@@ -13,6 +16,7 @@
 namespace Omega_h {
 
 static bool refine_ghosted(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("refine_ghosted");
   auto comm = mesh->comm();
   auto edges_are_cands = mesh->get_array<I8>(EDGE, "candidate");
   mesh->remove_tag(EDGE, "candidate");
@@ -37,11 +41,13 @@ static bool refine_ghosted(Mesh* mesh, AdaptOpts const& opts) {
 }
 
 static void refine_element_based(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("refine_element_based");
   auto comm = mesh->comm();
   auto edges_are_keys = mesh->get_array<I8>(EDGE, "key");
   auto keys2edges = collect_marked(edges_are_keys);
   auto nkeys = keys2edges.size();
   auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
+  count_refined_keys(ntotal_keys);
   if (opts.verbosity >= EACH_REBUILD && comm->rank() == 0) {
     std::cout << "refining " << ntotal_keys << " edges\n";
   }
@@ -49,6 +55,7 @@ static void refine_element_based(Mesh* mesh, AdaptOpts const& opts) {
   auto keys2midverts = LOs();
   auto old_verts2new_verts = LOs();
   auto old_lows2new_lows = LOs();
+  HostFew<LOs, 4> old_ents2new_ents_of_dim;
   for (Int ent_dim = 0; ent_dim <= mesh->dim(); ++ent_dim) {
     auto keys2prods = LOs();
     auto prod_verts2verts = LOs();
@@ -65,6 +72,9 @@ static void refine_element_based(Mesh* mesh, AdaptOpts const& opts) {
     modify_ents(mesh, &new_mesh, ent_dim, EDGE, keys2edges, keys2prods,
         prod_verts2verts, old_lows2new_lows, &prods2new_ents,
         &same_ents2old_ents, &same_ents2new_ents, &old_ents2new_ents);
+    old_ents2new_ents_of_dim[ent_dim] = old_ents2new_ents;
+    modify_up_adjs(
+        mesh, &new_mesh, ent_dim, old_ents2new_ents_of_dim, prods2new_ents);
     if (ent_dim == VERT) {
       keys2midverts = prods2new_ents;
       old_verts2new_verts = old_ents2new_ents;
@@ -85,12 +95,15 @@ static bool refine(Mesh* mesh, AdaptOpts const& opts) {
 }
 
 bool refine_by_size(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("refine");
+  ScopedMemoryLabel label("refine");
   auto comm = mesh->comm();
   auto lengths = mesh->ask_lengths();
-  auto edge_is_cand = each_gt(lengths, opts.max_length_desired);
-  if (comm->allreduce(max(edge_is_cand), OMEGA_H_MAX) != 1) return false;
+  auto edges_are_cands = restrict_to_adapt_region(
+      mesh, opts, EDGE, eval(lazy(lengths) > opts.max_length_desired));
+  if (comm->allreduce(max(edges_are_cands), OMEGA_H_MAX) != 1) return false;
   mesh->add_tag(EDGE, "candidate", 1, OMEGA_H_DONT_TRANSFER,
-      OMEGA_H_DONT_OUTPUT, edge_is_cand);
+      OMEGA_H_DONT_OUTPUT, edges_are_cands);
   return refine(mesh, opts);
 }
 
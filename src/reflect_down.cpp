@@ -4,6 +4,7 @@
 #include "array.hpp"
 #include "loop.hpp"
 #include "simplices.hpp"
+#include "vert_hash.hpp"
 
 namespace Omega_h {
 
@@ -102,7 +103,54 @@ Adj reflect_down(LOs hv2v, LOs lv2v, Adj v2l, Int high_dim, Int low_dim) {
   return Adj(hl2l, codes);
 }
 
+/* finds the low entity of each use through a hash table of the lows,
+   then aligns the two with the same IsMatch test as above */
+template <Int deg>
+static Adj reflect_down_by_hash_deg(LOs uv2v, LOs lv2v) {
+  LO nl = lv2v.size() / deg;
+  LO nu = uv2v.size() / deg;
+  auto table = make_vert_hash(nl, (nl ? max(lv2v) : -1) + 1);
+  auto insert = LAMBDA(LO l) {
+    LO v[deg];
+    get_sorted_verts<deg>(lv2v, l, v);
+    insert_vert_list<deg>(table, lv2v, l, v);
+  };
+  parallel_for(nl, insert);
+  Write<LO> ul2l(nu);
+  Write<I8> codes(nu);
+  auto f = LAMBDA(LO u) {
+    LO v[deg];
+    get_sorted_verts<deg>(uv2v, u, v);
+    auto l = find_vert_list<deg>(table, lv2v, v);
+    if (l == -1) NORETURN();
+    auto first = uv2v[u * deg];
+    for (Int which_down = 0; which_down < deg; ++which_down) {
+      if (lv2v[l * deg + which_down] != first) continue;
+      I8 match_code;
+      if (IsMatch<deg>::eval(
+              uv2v, u * deg, lv2v, l * deg, which_down, &match_code)) {
+        ul2l[u] = l;
+        codes[u] = match_code;
+        return;
+      }
+    }
+    NORETURN();
+  };
+  parallel_for(nu, f);
+  return Adj(ul2l, codes);
+}
+
+Adj reflect_down_by_hash(LOs hv2v, LOs lv2v, Int high_dim, Int low_dim) {
+  LOs uv2v = form_uses(hv2v, high_dim, low_dim);
+  if (low_dim == 2) return reflect_down_by_hash_deg<3>(uv2v, lv2v);
+  if (low_dim == 1) return reflect_down_by_hash_deg<2>(uv2v, lv2v);
+  NORETURN(Adj());
+}
+
 Adj reflect_down(LOs hv2v, LOs lv2v, LO nv, Int high_dim, Int low_dim) {
+  if (is_hashed_matching_enabled()) {
+    return reflect_down_by_hash(hv2v, lv2v, high_dim, low_dim);
+  }
   Int nverts_per_low = simplex_degrees[low_dim][0];
   LO nl = lv2v.size() / nverts_per_low;
   auto l2v = Adj(lv2v);
@@ -1,7 +1,9 @@
 #ifndef SCAN_HPP
 #define SCAN_HPP
 
+#include "Omega_h_functors.hpp"
 #include "internal.hpp"
+#include "loop.hpp"
 
 namespace Omega_h {
 
@@ -19,6 +21,43 @@ extern template LOs offset_scan(Read<I32> a);
    value to the left */
 void fill_right(Write<LO> a);
 
+template <typename Keep>
+struct CountIf : public SumFunctor<LO> {
+  using value_type = I64;
+  Keep keep_;
+  CountIf(Keep const& keep) : keep_(keep) {}
+  DEVICE void operator()(LO i, value_type& update) const {
+    if (keep_(i)) ++update;
+  }
+};
+
+template <typename Keep>
+struct CompactIf : public SumFunctor<LO> {
+  using value_type = I64;
+  Keep keep_;
+  Write<LO> out_;
+  CompactIf(Keep const& keep, Write<LO> out) : keep_(keep), out_(out) {}
+  DEVICE void operator()(LO i, value_type& update, bool final_pass) const {
+    if (keep_(i)) {
+      if (final_pass) out_[static_cast<LO>(update)] = i;
+      ++update;
+    }
+  }
+};
+
+/* stream compaction: returns, in increasing order, the indices (i)
+   in [0, n) for which keep(i) is true.
+   the exclusive scan of the kept flags and the scatter of the kept
+   indices are one scan, so unlike offset_scan() followed by a
+   parallel_for, no array of offsets is written and read back */
+template <typename Keep>
+LOs collect_if(LO n, Keep const& keep) {
+  auto nkept = static_cast<LO>(parallel_reduce(n, CountIf<Keep>(keep)));
+  Write<LO> kept(nkept);
+  parallel_scan(n, CompactIf<Keep>(keep, kept));
+  return kept;
+}
+
 }  // end namespace Omega_h
 
 #endif
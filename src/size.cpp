@@ -11,14 +11,16 @@
 
 namespace Omega_h {
 
+/* a null (a2e) means all edges, see measure_qualities_tmpl() */
 template <typename EdgeLengths>
 static Reals measure_edges_tmpl(Mesh* mesh, LOs a2e) {
   EdgeLengths measurer(mesh);
   auto ev2v = mesh->ask_verts_of(EDGE);
-  auto na = a2e.size();
+  auto all = !a2e.exists();
+  auto na = all ? mesh->nedges() : a2e.size();
   Write<Real> lengths(na);
   auto f = LAMBDA(LO a) {
-    auto e = a2e[a];
+    auto e = all ? a : a2e[a];
     auto v = gather_verts<2>(ev2v, e);
     lengths[a] = measurer.measure(v);
   };
@@ -57,11 +59,11 @@ Reals measure_edges_metric(Mesh* mesh, LOs a2e) {
 }
 
 Reals measure_edges_real(Mesh* mesh) {
-  return measure_edges_real(mesh, LOs(mesh->nedges(), 0, 1));
+  return measure_edges_real(mesh, LOs());
 }
 
 Reals measure_edges_metric(Mesh* mesh) {
-  return measure_edges_metric(mesh, LOs(mesh->nedges(), 0, 1));
+  return measure_edges_metric(mesh, LOs());
 }
 
 template <Int dim>
@@ -1,6 +1,9 @@
 #include "sort.hpp"
 
 #include <algorithm>
+#include <cstdint>
+
+#include "loop.hpp"
 
 #if defined(OMEGA_H_USE_CUDA)
 #ifdef __GNUC__
@@ -16,7 +19,8 @@
 #include <omp.h>
 #include "intel_sort/parallel_stable_sort.hpp"
 #include "intel_sort/pss_common.hpp"
-#else
+#elif defined(OMEGA_H_USE_THREADS)
+#include "threads.hpp"
 #endif
 
 namespace Omega_h {
@@ -61,7 +65,7 @@ static LOs sort_by_keys_tmpl(Read<T> keys) {
 }
 
 template <typename T>
-LOs sort_by_keys(Read<T> keys, Int width) {
+LOs comparison_sort_by_keys(Read<T> keys, Int width) {
   switch (width) {
     case 1:
       return sort_by_keys_tmpl<1>(keys);
@@ -73,7 +77,191 @@ LOs sort_by_keys(Read<T> keys, Int width) {
   NORETURN(LOs());
 }
 
-#define INST(T) template LOs sort_by_keys(Read<T> keys, Int width);
+#ifndef OMEGA_H_USE_CUDA
+
+/* Stable least-significant-digit radix sort of a permutation.
+   Keys are sorted one word at a time, from the last word of each
+   key set to the first. Each word is copied into a buffer in the
+   current order, biased so that unsigned order matches signed order,
+   and then sorted by one counting pass per RADIX_BITS-wide digit,
+   moving the (word, index) pairs between two buffers.
+   A counting pass is cut into contiguous blocks of elements:
+   each block histograms its digits, the histograms are scanned
+   digit-major, block-minor, and each block then scatters its
+   elements to their offsets in order, which keeps the pass stable.
+   Passes whose digit is the same for all elements only cost
+   the histogram, so keys that use few of their high bits
+   (local indices, ranks, Hilbert coordinates) are cheap. */
+
+enum { RADIX_BITS = 8, RADIX = 1 << RADIX_BITS };
+enum { MIN_RADIX_SORT = 2048, MIN_RADIX_BLOCK = 16384 };
+
+template <typename T>
+struct RadixTraits;
+
+template <>
+struct RadixTraits<I32> {
+  typedef std::uint32_t type;
+};
+
+template <>
+struct RadixTraits<I64> {
+  typedef std::uint64_t type;
+};
+
+/* flipping the sign bit makes unsigned order match signed order.
+   the flipped words are stored in the signed type, for which
+   arrays are instantiated, and cast back to read their digits */
+template <typename T>
+INLINE T radix_bias(T key) {
+  typedef typename RadixTraits<T>::type U;
+  return static_cast<T>(static_cast<U>(key) ^ (U(1) << (sizeof(U) * 8 - 1)));
+}
+
+template <typename T>
+INLINE Int radix_digit(T word, Int shift) {
+  typedef typename RadixTraits<T>::type U;
+  return static_cast<Int>((static_cast<U>(word) >> shift) & (RADIX - 1));
+}
+
+static LO get_radix_nworkers() {
+#if defined(OMEGA_H_USE_OPENMP)
+  return omp_get_max_threads();
+#elif defined(OMEGA_H_USE_THREADS)
+  return threads::nthreads();
+#else
+  return 1;
+#endif
+}
+
+/* blocks are few and large, so the built-in thread pool
+   (whose chunking assumes cheap iterations) is given
+   one chunk per block directly */
+#ifdef OMEGA_H_USE_THREADS
+template <typename F>
+struct BlockClosure {
+  F const* f;
+  static void run(void const* p, LO b) {
+    auto cl = static_cast<BlockClosure<F> const*>(p);
+    (*cl->f)(b);
+  }
+};
+#endif
+
+template <typename F>
+static void for_each_block(LO nblocks, F const& f) {
+#ifdef OMEGA_H_USE_THREADS
+  if (threads::can_fork(nblocks)) {
+    BlockClosure<F> closure = {&f};
+    threads::run_chunks(nblocks, BlockClosure<F>::run, &closure);
+    return;
+  }
+#endif
+  parallel_for(nblocks, f);
+}
+
+struct RadixBlocks {
+  LO n;
+  LO nblocks;
+  LO size;
+  RadixBlocks(LO n_) : n(n_) {
+    nblocks = max2<LO>(
+        1, min2<LO>(4 * get_radix_nworkers(), n / MIN_RADIX_BLOCK));
+    size = (n + nblocks - 1) / nblocks;
+  }
+  INLINE LO begin(LO b) const { return b * size; }
+  INLINE LO end(LO b) const { return min2<LO>(n, (b + 1) * size); }
+};
+
+/* sorts (words, perm) by the digit at (shift) into (words_out, perm_out).
+   returns false without writing the outputs if all elements
+   have the same digit */
+template <typename T>
+static bool radix_pass(RadixBlocks const& blocks, Int shift, Write<T> words,
+    Write<LO> perm, Write<T> words_out, Write<LO> perm_out) {
+  auto nblocks = blocks.nblocks;
+  Write<LO> offsets(RADIX * nblocks);
+  auto count = LAMBDA(LO b) {
+    LO counts[RADIX] = {0};
+    for (LO i = blocks.begin(b); i < blocks.end(b); ++i) {
+      ++counts[radix_digit(words[i], shift)];
+    }
+    for (Int d = 0; d < RADIX; ++d) offsets[d * nblocks + b] = counts[d];
+  };
+  for_each_block(nblocks, count);
+  auto first_digit = radix_digit(words.get(0), shift);
+  LO* offsets_ptr = offsets.data();
+  LO nfirst = 0;
+  for (LO b = 0; b < nblocks; ++b) {
+    nfirst += offsets_ptr[first_digit * nblocks + b];
+  }
+  if (nfirst == blocks.n) return false;
+  LO total = 0;
+  for (LO i = 0; i < RADIX * nblocks; ++i) {
+    auto count_i = offsets_ptr[i];
+    offsets_ptr[i] = total;
+    total += count_i;
+  }
+  auto scatter = LAMBDA(LO b) {
+    LO next[RADIX];
+    for (Int d = 0; d < RADIX; ++d) next[d] = offsets[d * nblocks + b];
+    for (LO i = blocks.begin(b); i < blocks.end(b); ++i) {
+      auto j = next[radix_digit(words[i], shift)]++;
+      words_out[j] = words[i];
+      perm_out[j] = perm[i];
+    }
+  };
+  for_each_block(nblocks, scatter);
+  return true;
+}
+
+template <typename T>
+LOs radix_sort_by_keys(Read<T> keys, Int width) {
+  CHECK(keys.size() % width == 0);
+  auto n = keys.size() / width;
+  Write<LO> perm(n, 0, 1);
+  if (n == 0) return perm;
+  Write<LO> perm_out(n);
+  Write<T> words(n);
+  Write<T> words_out(n);
+  RadixBlocks blocks(n);
+  for (Int w = width - 1; w >= 0; --w) {
+    auto gather = LAMBDA(LO i) {
+      words[i] = radix_bias(keys[perm[i] * width + w]);
+    };
+    parallel_for(n, gather);
+    for (Int shift = 0; shift < Int(sizeof(T) * 8); shift += RADIX_BITS) {
+      if (radix_pass(blocks, shift, words, perm, words_out, perm_out)) {
+        std::swap(words, words_out);
+        std::swap(perm, perm_out);
+      }
+    }
+  }
+  return perm;
+}
+
+#endif
+
+template <typename T>
+LOs sort_by_keys(Read<T> keys, Int width) {
+#ifndef OMEGA_H_USE_CUDA
+  if (keys.size() / width >= MIN_RADIX_SORT) {
+    return radix_sort_by_keys(keys, width);
+  }
+#endif
+  return comparison_sort_by_keys(keys, width);
+}
+
+#ifdef OMEGA_H_USE_CUDA
+#define INST(T)                                                                \
+  template LOs sort_by_keys(Read<T> keys, Int width);                          \
+  template LOs comparison_sort_by_keys(Read<T> keys, Int width);
+#else
+#define INST(T)                                                                \
+  template LOs sort_by_keys(Read<T> keys, Int width);                          \
+  template LOs comparison_sort_by_keys(Read<T> keys, Int width);               \
+  template LOs radix_sort_by_keys(Read<T> keys, Int width);
+#endif
 INST(LO)
 INST(GO)
 #undef INST
@@ -5,10 +5,33 @@
 
 namespace Omega_h {
 
+/* returns the stable permutation that sorts the key sets
+   of (width) integers each in lexicographical order.
+   large inputs use radix_sort_by_keys() except on CUDA,
+   the others use comparison_sort_by_keys() */
 template <typename T>
 LOs sort_by_keys(Read<T> keys, Int width = 1);
 
-#define INST_DECL(T) extern template LOs sort_by_keys(Read<T> keys, Int width);
+/* supports width 1, 2, or 3 */
+template <typename T>
+LOs comparison_sort_by_keys(Read<T> keys, Int width = 1);
+
+#ifndef OMEGA_H_USE_CUDA
+/* supports any width */
+template <typename T>
+LOs radix_sort_by_keys(Read<T> keys, Int width = 1);
+#endif
+
+#ifdef OMEGA_H_USE_CUDA
+#define INST_DECL(T)                                                           \
+  extern template LOs sort_by_keys(Read<T> keys, Int width);                   \
+  extern template LOs comparison_sort_by_keys(Read<T> keys, Int width);
+#else
+#define INST_DECL(T)                                                           \
+  extern template LOs sort_by_keys(Read<T> keys, Int width);                   \
+  extern template LOs comparison_sort_by_keys(Read<T> keys, Int width);        \
+  extern template LOs radix_sort_by_keys(Read<T> keys, Int width);
+#endif
 INST_DECL(LO)
 INST_DECL(GO)
 #undef INST_DECL
@@ -66,6 +66,32 @@ INLINE Matrix<3, 3> invert(Matrix<3, 3> a) {
   return transpose(b) / determinant(a);
 }
 
+/* the inverse of a symmetric matrix is symmetric, so only
+   the unique cofactors need to be formed */
+INLINE Matrix<2, 2> invert_symm(Matrix<2, 2> m) {
+  Real a = m[0][0];
+  Real b = m[1][0];
+  Real d = m[1][1];
+  return matrix_2x2(d, -b, -b, a) / (a * d - b * b);
+}
+
+INLINE Matrix<3, 3> invert_symm(Matrix<3, 3> m) {
+  Real a = m[0][0];
+  Real b = m[1][0];
+  Real c = m[2][0];
+  Real d = m[1][1];
+  Real e = m[2][1];
+  Real f = m[2][2];
+  Real ca = d * f - e * e;
+  Real cb = c * e - b * f;
+  Real cc = b * e - c * d;
+  Real cd = a * f - c * c;
+  Real ce = b * c - a * e;
+  Real cf = a * d - b * b;
+  Real det = a * ca + b * cb + c * cc;
+  return matrix_3x3(ca, cb, cc, cb, cd, ce, cc, ce, cf) / det;
+}
+
 INLINE Matrix<2, 2> form_ortho_basis(Vector<2> v) {
   Matrix<2, 2> A;
   A[0] = normalize(v);
@@ -16,6 +16,8 @@ bool swap_part1(Mesh* mesh, AdaptOpts const& opts) {
   auto comm = mesh->comm();
   auto elems_are_cands =
       mark_sliver_layers(mesh, opts.min_quality_desired, opts.nsliver_layers);
+  elems_are_cands =
+      restrict_to_adapt_region(mesh, opts, mesh->dim(), elems_are_cands);
   CHECK(comm->allreduce(max(elems_are_cands), OMEGA_H_MAX) == 1);
   auto edges_are_cands = mark_down(mesh, mesh->dim(), EDGE, elems_are_cands);
   /* only swap interior edges */
@@ -44,6 +46,8 @@ Read<I8> filter_swap_improve(Mesh* mesh, LOs cands2edges, Reals cand_quals) {
 }
 
 bool swap_edges(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("swap");
+  ScopedMemoryLabel label("swap");
   if (mesh->dim() == 3) return swap_edges_3d(mesh, opts);
   if (mesh->dim() == 2) return swap_edges_2d(mesh, opts);
   return false;
@@ -2,6 +2,7 @@
 
 #include <iostream>
 
+#include "adapt.hpp"
 #include "indset.hpp"
 #include "map.hpp"
 #include "modify.hpp"
@@ -12,6 +13,7 @@
 namespace Omega_h {
 
 static bool swap3d_ghosted(Mesh* mesh) {
+  profile::Region region("swap3d_ghosted");
   auto comm = mesh->comm();
   auto edges_are_cands = mesh->get_array<I8>(EDGE, "candidate");
   mesh->remove_tag(EDGE, "candidate");
@@ -51,16 +53,18 @@ static bool swap3d_ghosted(Mesh* mesh) {
 }
 
 static void swap3d_element_based(Mesh* mesh, AdaptOpts const& opts) {
+  profile::Region region("swap3d_element_based");
   auto comm = mesh->comm();
   auto edges_are_keys = mesh->get_array<I8>(EDGE, "key");
   mesh->remove_tag(EDGE, "key");
   auto edges_configs = mesh->get_array<I8>(EDGE, "config");
   mesh->remove_tag(EDGE, "config");
   auto keys2edges = collect_marked(edges_are_keys);
-  if (opts.verbosity >= EACH_REBUILD) {
+  if (opts.verbosity >= EACH_REBUILD || is_counting_adapt_keys()) {
     auto nkeys = keys2edges.size();
     auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
-    if (comm->rank() == 0) {
+    count_swapped_keys(ntotal_keys);
+    if (opts.verbosity >= EACH_REBUILD && comm->rank() == 0) {
       std::cout << "swapping " << ntotal_keys << " 3D edges\n";
     }
   }
@@ -74,6 +78,8 @@ static void swap3d_element_based(Mesh* mesh, AdaptOpts const& opts) {
   auto same_verts2old_verts = LOs(mesh->nverts(), 0, 1);
   auto same_verts2new_verts = same_verts2old_verts;
   auto old_lows2new_lows = same_verts2old_verts;
+  HostFew<LOs, 4> old_ents2new_ents_of_dim;
+  old_ents2new_ents_of_dim[VERT] = same_verts2old_verts;
   for (Int ent_dim = EDGE; ent_dim <= mesh->dim(); ++ent_dim) {
     auto prods2new_ents = LOs();
     auto same_ents2old_ents = LOs();
@@ -82,6 +88,9 @@ static void swap3d_element_based(Mesh* mesh, AdaptOpts const& opts) {
     modify_ents(mesh, &new_mesh, ent_dim, EDGE, keys2edges, keys2prods[ent_dim],
         prod_verts2verts[ent_dim], old_lows2new_lows, &prods2new_ents,
         &same_ents2old_ents, &same_ents2new_ents, &old_ents2new_ents);
+    old_ents2new_ents_of_dim[ent_dim] = old_ents2new_ents;
+    modify_up_adjs(
+        mesh, &new_mesh, ent_dim, old_ents2new_ents_of_dim, prods2new_ents);
     transfer_swap(mesh, &new_mesh, ent_dim, keys2edges, keys2prods[ent_dim],
         prods2new_ents, same_ents2old_ents, same_ents2new_ents,
         same_verts2old_verts, same_verts2new_verts);
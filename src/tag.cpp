@@ -1,14 +1,60 @@
 #include "tag.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 namespace Omega_h {
 
+namespace {
+
+struct TagNames {
+  std::unordered_map<std::string, Int> ids;
+  std::vector<std::string> names;
+};
+
+TagNames& get_tag_names() {
+  static TagNames tag_names;
+  return tag_names;
+}
+
+}  // end anonymous namespace
+
+Int intern_tag_name(std::string const& name) {
+  auto& tag_names = get_tag_names();
+  auto it = tag_names.ids.find(name);
+  if (it != tag_names.ids.end()) return it->second;
+  auto id = Int(tag_names.names.size());
+  tag_names.ids[name] = id;
+  tag_names.names.push_back(name);
+  return id;
+}
+
+Int find_tag_name(std::string const& name) {
+  auto const& tag_names = get_tag_names();
+  auto it = tag_names.ids.find(name);
+  if (it == tag_names.ids.end()) return -1;
+  return it->second;
+}
+
+std::string const& get_tag_name(Int name_id) {
+  auto const& tag_names = get_tag_names();
+  CHECK(0 <= name_id && std::size_t(name_id) < tag_names.names.size());
+  return tag_names.names[std::size_t(name_id)];
+}
+
 TagBase::TagBase(std::string const& name, Int ncomps, Int xfer, Int outflags)
-    : name_(name), ncomps_(ncomps), xfer_(xfer), outflags_(outflags) {}
+    : name_(name),
+      name_id_(intern_tag_name(name)),
+      ncomps_(ncomps),
+      xfer_(xfer),
+      outflags_(outflags) {}
 
 TagBase::~TagBase() = default;
 
 std::string const& TagBase::name() const { return name_; }
 
+Int TagBase::name_id() const { return name_id_; }
+
 Int TagBase::ncomps() const { return ncomps_; }
 
 Int TagBase::xfer() const { return xfer_; }
@@ -0,0 +1,179 @@
+#include "threads.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Omega_h {
+
+namespace threads {
+
+/* each thread's block of chunks [first, last) is packed
+   into one 64-bit word, so the owner (taking from the front)
+   and thieves (taking from the back) agree using a single
+   compare-and-swap */
+struct Block {
+  std::atomic<std::uint64_t> range;
+  char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+};
+
+static std::uint64_t pack_range(LO first, LO last) {
+  return (std::uint64_t(std::uint32_t(first)) << 32) |
+         std::uint64_t(std::uint32_t(last));
+}
+
+static LO range_first(std::uint64_t range) { return LO(range >> 32); }
+
+static LO range_last(std::uint64_t range) {
+  return LO(range & 0xffffffffu);
+}
+
+static bool take_front(Block& block, LO* chunk) {
+  auto range = block.range.load();
+  while (true) {
+    auto first = range_first(range);
+    auto last = range_last(range);
+    if (first >= last) return false;
+    if (block.range.compare_exchange_weak(range, pack_range(first + 1, last))) {
+      *chunk = first;
+      return true;
+    }
+  }
+}
+
+static bool take_back(Block& block, LO* chunk) {
+  auto range = block.range.load();
+  while (true) {
+    auto first = range_first(range);
+    auto last = range_last(range);
+    if (first >= last) return false;
+    if (block.range.compare_exchange_weak(range, pack_range(first, last - 1))) {
+      *chunk = last - 1;
+      return true;
+    }
+  }
+}
+
+struct Pool {
+  Int nthreads;
+  std::vector<std::thread> workers;
+  std::unique_ptr<Block[]> blocks;
+  std::mutex launch_mutex;
+  std::mutex mutex;
+  std::condition_variable start_cv;
+  std::condition_variable done_cv;
+  std::uint64_t generation;
+  Int nfinished;
+  bool stopping;
+  ChunkFunction f;
+  void const* closure;
+};
+
+static Pool* pool = nullptr;
+static thread_local bool in_loop = false;
+
+static void do_chunks(Int self) {
+  auto f = pool->f;
+  auto closure = pool->closure;
+  LO chunk;
+  while (take_front(pool->blocks[self], &chunk)) f(closure, chunk);
+  for (Int i = 1; i < pool->nthreads; ++i) {
+    auto& victim = pool->blocks[(self + i) % pool->nthreads];
+    while (take_back(victim, &chunk)) f(closure, chunk);
+  }
+}
+
+static void finish_chunks() {
+  std::lock_guard<std::mutex> lock(pool->mutex);
+  if (++pool->nfinished == pool->nthreads) pool->done_cv.notify_one();
+}
+
+static void worker_main(Int self) {
+  in_loop = true;
+  std::uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(pool->mutex);
+      pool->start_cv.wait(
+          lock, [&] { return pool->stopping || pool->generation != seen; });
+      if (pool->stopping) return;
+      seen = pool->generation;
+    }
+    do_chunks(self);
+    finish_chunks();
+  }
+}
+
+static Int default_nthreads() {
+  auto env = std::getenv("OMEGA_H_NUM_THREADS");
+  if (env) {
+    auto n = std::atoi(env);
+    if (n > 0) return n;
+  }
+  auto n = static_cast<Int>(std::thread::hardware_concurrency());
+  return max2<Int>(n, 1);
+}
+
+void init(Int nthreads) {
+  if (pool) return;
+  if (nthreads <= 0) nthreads = default_nthreads();
+  pool = new Pool();
+  pool->nthreads = nthreads;
+  pool->blocks.reset(new Block[nthreads]);
+  for (Int i = 0; i < nthreads; ++i) pool->blocks[i].range = 0;
+  pool->generation = 0;
+  pool->nfinished = 0;
+  pool->stopping = false;
+  pool->f = nullptr;
+  pool->closure = nullptr;
+  for (Int i = 1; i < nthreads; ++i) pool->workers.emplace_back(worker_main, i);
+}
+
+void finalize() {
+  if (!pool) return;
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->stopping = true;
+  }
+  pool->start_cv.notify_all();
+  for (auto& worker : pool->workers) worker.join();
+  delete pool;
+  pool = nullptr;
+}
+
+Int nthreads() { return pool ? pool->nthreads : 1; }
+
+bool can_fork(LO nchunks) {
+  return pool && pool->nthreads > 1 && nchunks > 1 && !in_loop;
+}
+
+void run_chunks(LO nchunks, ChunkFunction f, void const* closure) {
+  std::lock_guard<std::mutex> launch_lock(pool->launch_mutex);
+  auto nthreads = pool->nthreads;
+  for (Int i = 0; i < nthreads; ++i) {
+    auto first = static_cast<LO>((I64(nchunks) * i) / nthreads);
+    auto last = static_cast<LO>((I64(nchunks) * (i + 1)) / nthreads);
+    pool->blocks[i].range = pack_range(first, last);
+  }
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->f = f;
+    pool->closure = closure;
+    pool->nfinished = 0;
+    ++pool->generation;
+  }
+  pool->start_cv.notify_all();
+  in_loop = true;
+  do_chunks(0);
+  in_loop = false;
+  std::unique_lock<std::mutex> lock(pool->mutex);
+  ++pool->nfinished;
+  pool->done_cv.wait(lock, [] { return pool->nfinished == pool->nthreads; });
+}
+
+}  // end namespace threads
+
+}  // end namespace Omega_h
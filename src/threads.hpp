@@ -0,0 +1,57 @@
+#ifndef THREADS_HPP
+#define THREADS_HPP
+
+#include "internal.hpp"
+
+namespace Omega_h {
+
+/* The built-in on-node backend used when Kokkos is absent
+   and OMEGA_H_USE_THREADS is defined.
+
+   A loop of (n) iterations is cut into chunks whose boundaries
+   depend only on (n), never on the number of threads.
+   The chunks are dealt out in contiguous blocks, one per thread,
+   and a thread which runs out of its own chunks steals chunks
+   from the back of the other threads' blocks.
+   Because reductions and scans combine per-chunk partial values
+   in chunk order, their results do not depend on the number
+   of threads or on which thread ran which chunk. */
+
+namespace threads {
+
+/* nthreads <= 0 means "use $OMEGA_H_NUM_THREADS if it is set,
+   otherwise std::thread::hardware_concurrency()" */
+void init(Int nthreads);
+void finalize();
+Int nthreads();
+
+typedef void (*ChunkFunction)(void const* closure, LO chunk);
+
+/* true if a loop of (nchunks) chunks should be run by the pool.
+   this is false for single chunks, single threads, and calls
+   made from inside a running loop (no nested parallelism) */
+bool can_fork(LO nchunks);
+
+/* calls f(closure, c) for every c in [0, nchunks) and
+   returns once all of those calls have completed */
+void run_chunks(LO nchunks, ChunkFunction f, void const* closure);
+
+struct Chunking {
+  enum { MIN_CHUNK_SIZE = 1024, MAX_NCHUNKS = 1024 };
+  LO n;
+  LO size;
+  LO nchunks;
+  Chunking(LO n_) : n(n_) {
+    auto even = static_cast<LO>((I64(n) + MAX_NCHUNKS - 1) / MAX_NCHUNKS);
+    size = max2<LO>(LO(MIN_CHUNK_SIZE), even);
+    nchunks = (n + size - 1) / size;
+  }
+  LO begin(LO c) const { return c * size; }
+  LO end(LO c) const { return static_cast<LO>(min2<I64>(n, I64(c + 1) * size)); }
+};
+
+}  // end namespace threads
+
+}  // end namespace Omega_h
+
+#endif
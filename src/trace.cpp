@@ -0,0 +1,194 @@
+#include "trace.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+#include "scan.hpp"
+
+namespace Omega_h {
+
+namespace tracing {
+
+bool recording = false;
+
+struct Event {
+  std::string const* name;
+  char const* category;
+  char phase;
+  Real time;
+  Real duration;
+  LO n;
+};
+
+struct Recorder {
+  Now origin;
+  std::vector<Event> events;
+  std::map<std::string, std::string> names;  // interned event names
+  std::mutex mutex;
+};
+
+static Recorder& get_recorder() {
+  static Recorder recorder;
+  return recorder;
+}
+
+static std::string const* intern(Recorder& recorder, std::string const& s) {
+  auto it = recorder.names.find(s);
+  if (it == recorder.names.end()) it = recorder.names.insert({s, s}).first;
+  return &(it->second);
+}
+
+static std::string demangle(char const* mangled) {
+#ifdef __GNUC__
+  int status;
+  char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+  if (status == 0) {
+    std::string s(demangled);
+    std::free(demangled);
+    return s;
+  }
+#endif
+  return mangled;
+}
+
+static void add_event(char const* category, char phase,
+    std::string const* name, Now start, Now end, LO n) {
+  auto& recorder = get_recorder();
+  Event event;
+  event.name = name;
+  event.category = category;
+  event.phase = phase;
+  event.time = (start - recorder.origin) * 1e6;
+  event.duration = (end - start) * 1e6;
+  event.n = n;
+  recorder.events.push_back(event);
+}
+
+void begin_region(char const* name) {
+  auto& recorder = get_recorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  auto t = now();
+  add_event("region", 'B', intern(recorder, name), t, t, -1);
+}
+
+void end_region() {
+  auto& recorder = get_recorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  auto t = now();
+  add_event("region", 'E', nullptr, t, t, -1);
+}
+
+void record_kernel(std::type_info const& functor_type, char const* pattern,
+    LO n, Now start, Now end) {
+  auto& recorder = get_recorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  auto mangled = std::string(functor_type.name());
+  auto it = recorder.names.find(mangled);
+  std::string const* name;
+  if (it == recorder.names.end()) {
+    name = &(recorder.names.insert({mangled, demangle(mangled.c_str())})
+                 .first->second);
+  } else {
+    name = &(it->second);
+  }
+  add_event(pattern, 'X', name, start, end, n);
+}
+
+void start(CommPtr comm) {
+  auto& recorder = get_recorder();
+  recorder.events.clear();
+  comm->barrier();
+  recorder.origin = now();
+  recording = true;
+}
+
+void stop() { recording = false; }
+
+bool is_recording() { return recording; }
+
+static std::string escape(std::string const& s) {
+  std::string escaped;
+  for (auto c : s) {
+    if (c == '"' || c == '\\') escaped.push_back('\\');
+    escaped.push_back(c);
+  }
+  return escaped;
+}
+
+/* this rank's events, comma-separated, without the enclosing array */
+static std::string format_events(I32 rank) {
+  auto& recorder = get_recorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  std::stringstream stream;
+  stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank
+         << ",\"args\":{\"name\":\"rank " << rank << "\"}}";
+  char buf[64];
+  for (auto& event : recorder.events) {
+    stream << ",\n{";
+    if (event.name) stream << "\"name\":\"" << escape(*event.name) << "\",";
+    stream << "\"cat\":\"" << event.category << "\",\"ph\":\""
+           << event.phase << "\",\"pid\":" << rank << ",\"tid\":0";
+    std::snprintf(buf, sizeof(buf), ",\"ts\":%.3f", event.time);
+    stream << buf;
+    if (event.phase == 'X') {
+      std::snprintf(buf, sizeof(buf), ",\"dur\":%.3f", event.duration);
+      stream << buf << ",\"args\":{\"n\":" << event.n << "}";
+    }
+    stream << "}";
+  }
+  return stream.str();
+}
+
+static void write_file(std::string const& path, std::string const& events) {
+  std::ofstream file(path.c_str());
+  if (!file.is_open()) {
+    Omega_h_fail("couldn't open trace file \"%s\"\n", path.c_str());
+  }
+  file << "{\"traceEvents\":[\n" << events << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+static std::string gather_to_root(CommPtr comm, std::string const& local) {
+  auto is_root = (comm->rank() == 0);
+  auto srcs = is_root ? Read<I32>(comm->size(), 0, 1) : Read<I32>({});
+  auto gather_comm = comm->graph_adjacent(srcs, Read<I32>({0}));
+  auto nlocal = static_cast<LO>(local.size());
+  auto recvcounts = gather_comm->allgather(nlocal);
+  auto rdispls = offset_scan(recvcounts);
+  HostWrite<I8> sendbuf(nlocal);
+  for (LO i = 0; i < nlocal; ++i) sendbuf[i] = static_cast<I8>(local[i]);
+  auto recvd = gather_comm->alltoallv(Read<I8>(sendbuf.write()),
+      Read<LO>({nlocal}), Read<LO>({0, nlocal}), recvcounts, rdispls);
+  if (!is_root) return std::string();
+  HostRead<I8> host_recvd(recvd);
+  HostRead<LO> host_rdispls(rdispls);
+  std::string all;
+  for (LO i = 0; i + 1 < host_rdispls.size(); ++i) {
+    if (i) all += ",\n";
+    for (LO j = host_rdispls[i]; j < host_rdispls[i + 1]; ++j) {
+      all.push_back(static_cast<char>(host_recvd[j]));
+    }
+  }
+  return all;
+}
+
+void write(CommPtr comm, std::string const& path, bool merged) {
+  auto events = format_events(comm->rank());
+  if (!merged) {
+    write_file(path + "." + std::to_string(comm->rank()), events);
+    return;
+  }
+  auto all = gather_to_root(comm, events);
+  if (comm->rank() == 0) write_file(path, all);
+}
+
+}  // end namespace tracing
+
+}  // end namespace Omega_h
@@ -0,0 +1,46 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <typeinfo>
+
+#include "internal.hpp"
+#include "timer.hpp"
+
+namespace Omega_h {
+
+namespace tracing {
+
+/* read by every instrumented scope, hence a plain
+   variable rather than a call to is_recording() */
+extern bool recording;
+
+void begin_region(char const* name);
+void end_region();
+void record_kernel(std::type_info const& functor_type, char const* pattern,
+    LO n, Now start, Now end);
+
+class KernelScope {
+  std::type_info const& functor_type_;
+  char const* pattern_;
+  LO n_;
+  bool is_traced_;
+  Now start_;
+
+ public:
+  KernelScope(std::type_info const& functor_type, char const* pattern, LO n)
+      : functor_type_(functor_type),
+        pattern_(pattern),
+        n_(n),
+        is_traced_(recording) {
+    if (is_traced_) start_ = now();
+  }
+  ~KernelScope() {
+    if (is_traced_) record_kernel(functor_type_, pattern_, n_, start_, now());
+  }
+};
+
+}  // end namespace tracing
+
+}  // end namespace Omega_h
+
+#endif
@@ -37,8 +37,8 @@ void transfer_common2(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
   auto const& name = tagbase->name();
   auto ncomps = tagbase->ncomps();
   auto old_data = old_mesh->get_array<T>(ent_dim, name);
-  auto same_data = unmap(same_ents2old_ents, old_data, ncomps);
-  map_into(same_data, same_ents2new_ents, new_data, ncomps);
+  unmap_into(same_ents2old_ents, old_data, same_ents2new_ents, new_data,
+      ncomps);
   transfer_common3(new_mesh, ent_dim, tagbase, new_data);
 }
 
@@ -228,6 +228,7 @@ static void transfer_quality(Mesh* old_mesh, Mesh* new_mesh,
 void transfer_refine(Mesh* old_mesh, Mesh* new_mesh, LOs keys2edges,
     LOs keys2midverts, Int prod_dim, LOs keys2prods, LOs prods2new_ents,
     LOs same_ents2old_ents, LOs same_ents2new_ents) {
+  profile::Region region("transfer_refine");
   transfer_inherit_refine(old_mesh, new_mesh, keys2edges, prod_dim, keys2prods,
       prods2new_ents, same_ents2old_ents, same_ents2new_ents);
   if (prod_dim == VERT) {
@@ -414,6 +415,7 @@ void transfer_coarsen(Mesh* old_mesh, Mesh* new_mesh, LOs keys2verts,
     Adj keys2doms, Int prod_dim, LOs prods2new_ents, LOs same_ents2old_ents,
     LOs same_ents2new_ents, LOs same_verts2old_verts,
     LOs same_verts2new_verts) {
+  profile::Region region("transfer_coarsen");
   if (prod_dim == VERT) {
     transfer_no_products(
         old_mesh, new_mesh, prod_dim, same_ents2old_ents, same_ents2new_ents);
@@ -451,6 +453,7 @@ static void transfer_copy_tmpl(
 }
 
 void transfer_copy(Mesh* old_mesh, Mesh* new_mesh, Int prod_dim) {
+  profile::Region region("transfer_copy");
   for (Int i = 0; i < old_mesh->ntags(prod_dim); ++i) {
     auto tagbase = old_mesh->get_tag(prod_dim, i);
     if (tagbase->xfer() != OMEGA_H_DONT_TRANSFER &&
@@ -523,6 +526,7 @@ void transfer_swap(Mesh* old_mesh, Mesh* new_mesh, Int prod_dim, LOs keys2edges,
     LOs keys2prods, LOs prods2new_ents, LOs same_ents2old_ents,
     LOs same_ents2new_ents, LOs same_verts2old_verts,
     LOs same_verts2new_verts) {
+  profile::Region region("transfer_swap");
   CHECK(prod_dim != VERT);
   transfer_inherit_swap(old_mesh, new_mesh, prod_dim, keys2edges, keys2prods,
       prods2new_ents, same_ents2old_ents, same_ents2new_ents);
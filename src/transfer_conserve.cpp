@@ -254,8 +254,8 @@ class MomentumVelocity {
     this->donor_masses = donor_mesh->get_array<Real>(dim, "mass");
     this->donor_velocities = to<Real>(tagbase)->array();
     this->target_velocities = Write<Real>(target_mesh->nverts() * dim);
-    auto same_velocities = unmap(same_verts2old_verts, donor_velocities, dim);
-    map_into(same_velocities, same_verts2new_verts, target_velocities, dim);
+    unmap_into(same_verts2old_verts, donor_velocities, same_verts2new_verts,
+        target_velocities, dim);
     auto keys2target_interior = Graph(keys2prods, prods2new_elems);
     this->keys2target_verts =
         get_closure_verts(target_mesh, keys2target_interior);
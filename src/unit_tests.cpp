@@ -3,11 +3,16 @@
 #include "align.hpp"
 #include "array.hpp"
 #include "bbox.hpp"
+#include "bits.hpp"
+#include "coarsen.hpp"
 #include "derive.hpp"
 #include "eigen.hpp"
+#include "expr.hpp"
 #include "file.hpp"
 #include "graph.hpp"
 #include "hilbert.hpp"
+#include "histogram.hpp"
+#include "indset.hpp"
 #include "inertia.hpp"
 #include "int128.hpp"
 #include "internal.hpp"
@@ -16,6 +21,7 @@
 #include "map.hpp"
 #include "mark.hpp"
 #include "quality.hpp"
+#include "refine.hpp"
 #include "refine_qualities.hpp"
 #include "scan.hpp"
 #include "size.hpp"
@@ -27,6 +33,10 @@
 #include "vtk.hpp"
 #include "xml.hpp"
 
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
 #include <sstream>
 
 using namespace Omega_h;
@@ -122,6 +132,15 @@ static void test_eigen_cubic_ortho(Matrix<3, 3> m, Vector<3> l_expect) {
   CHECK(are_close(m, compose_ortho(q, l), 1e-8, 1e-8));
 }
 
+static void test_eigen_symm(Matrix<3, 3> m, Vector<3> l_expect) {
+  auto ed = decompose_symm(m);
+  auto q = ed.q;
+  auto l = ed.l;
+  CHECK(are_close(transpose(q) * q, identity_matrix<3, 3>(), 1e-8, 1e-8));
+  CHECK(are_close(l, l_expect, 1e-8, 1e-8));
+  CHECK(are_close(m, compose_ortho(q, l), 1e-8, 1e-8));
+}
+
 static void test_eigen_metric(Vector<3> h) {
   auto q =
       rotate(PI / 4., vector_3(0, 0, 1)) * rotate(PI / 4., vector_3(0, 1, 0));
@@ -129,6 +148,13 @@ static void test_eigen_metric(Vector<3> h) {
   auto l = metric_eigenvalues(h);
   auto a = compose_ortho(q, l);
   test_eigen_cubic_ortho(a, l);
+  test_eigen_symm(a, l);
+  /* compare against the exact inverse, scaled to be of order one */
+  Vector<3> inv_l;
+  for (Int i = 0; i < 3; ++i) inv_l[i] = square(h[i]);
+  auto inv = compose_ortho(q, inv_l);
+  auto s = max_norm(inv);
+  CHECK(are_close(invert_symm(a) / s, inv / s, 1e-5, 1e-5));
 }
 
 static void test_eigen_cubic() {
@@ -146,6 +172,45 @@ static void test_eigen_cubic() {
   test_eigen_metric(vector_3(1e-3, 1, 1));
   test_eigen_metric(vector_3(1, 1e-3, 1e-3));
   test_eigen_metric(vector_3(1e-6, 1e-3, 1e-3));
+  /* distinct roots come out as (largest, smallest, middle) */
+  test_eigen_metric(vector_3(1e-3, 1, 1e-2));
+}
+
+static void test_eigen_symms() {
+  /* the batched kernels against the general per-tensor ones */
+  Write<Real> w(4 * 6);
+  set_symm(w, 0, matrix_3x3(2, 1, 0, 1, 3, 1, 0, 1, 4));
+  set_symm(w, 1, identity_matrix<3, 3>());
+  set_symm(w, 2, compose_metric(rotate(PI / 3., vector_3(1, 0, 0)),
+                     vector_3(1e-3, 1, 1)));
+  set_symm(w, 3, diagonal(vector_3(5, 2, 7)));
+  auto symms = Reals(w);
+  auto decomps = decompose_symms(3, symms);
+  auto invs = invert_symms(3, symms);
+  auto h_symms = HostRead<Real>(symms);
+  auto h_q = HostRead<Real>(decomps.q);
+  auto h_l = HostRead<Real>(decomps.l);
+  auto h_invs = HostRead<Real>(invs);
+  for (Int i = 0; i < 4; ++i) {
+    auto m = get_symm<3>(h_symms, i);
+    auto ed = decompose_eigen(m);
+    Matrix<3, 3> q;
+    for (Int j = 0; j < 3; ++j)
+      for (Int k = 0; k < 3; ++k) q[j][k] = h_q[(i * 3 + j) * 3 + k];
+    auto l = get_vector<3>(h_l, i);
+    CHECK(are_close(l, ed.l, 1e-8, 1e-8));
+    CHECK(are_close(compose_ortho(q, l), m, 1e-8, 1e-8));
+    CHECK(are_close(get_symm<3>(h_invs, i), invert(m)));
+  }
+  auto m2 = matrix_2x2(2, 1, 1, 3);
+  auto decomps2 = decompose_symms(2, Reals({2, 3, 1}));
+  auto h_q2 = HostRead<Real>(decomps2.q);
+  auto q2 = matrix_2x2(h_q2[0], h_q2[2], h_q2[1], h_q2[3]);
+  auto l2 = get_vector<2>(HostRead<Real>(decomps2.l), 0);
+  CHECK(are_close(l2, decompose_eigen(m2).l));
+  CHECK(are_close(compose_ortho(q2, l2), m2));
+  auto inv2 = invert_symms(2, Reals({2, 3, 1}));
+  CHECK(are_close(get_symm<2>(HostRead<Real>(inv2), 0), invert(m2)));
 }
 
 static void test_intersect_ortho_metrics(
@@ -185,6 +250,83 @@ static void test_intersect_metrics() {
   test_intersect_subset_metrics();
 }
 
+/* limit_metric_gradation() before the symmetric kernels: general
+   inverses and eigendecompositions, one per adjacency */
+static Matrix<3, 3> intersect_metrics_general(
+    Matrix<3, 3> m1, Matrix<3, 3> m2) {
+  auto n_decomp = decompose_eigen(invert(m1) * m2);
+  bool all_above_one = true;
+  bool all_below_one = true;
+  for (Int i = 0; i < 3; ++i) {
+    if (n_decomp.l[i] > 1) all_below_one = false;
+    if (n_decomp.l[i] < 1) all_above_one = false;
+  }
+  if (all_below_one) return m1;
+  if (all_above_one) return m2;
+  auto p = n_decomp.q;
+  Vector<3> w;
+  for (Int i = 0; i < 3; ++i) {
+    w[i] = max2(metric_product(m1, p[i]), metric_product(m2, p[i]));
+  }
+  auto ip = invert(p);
+  return transpose(ip) * diagonal(w) * ip;
+}
+
+static Reals limit_metric_gradation_general(
+    Mesh* mesh, Reals metrics, Real max_rate) {
+  auto v2v = mesh->ask_star(VERT);
+  auto coords = mesh->coords();
+  auto log_rate = ::log(max_rate);
+  Reals metrics2 = metrics;
+  do {
+    metrics = metrics2;
+    auto out = Write<Real>(metrics.size());
+    auto f = LAMBDA(LO v) {
+      auto m = get_symm<3>(metrics, v);
+      auto x = get_vector<3>(coords, v);
+      for (auto vv = v2v.a2ab[v]; vv < v2v.a2ab[v + 1]; ++vv) {
+        auto av = v2v.ab2b[vv];
+        auto decomp = decompose_eigen(get_symm<3>(metrics, av));
+        auto dist = norm(get_vector<3>(coords, av) - x);
+        for (Int i = 0; i < 3; ++i) {
+          decomp.l[i] /= square(1 + decomp.l[i] * dist * log_rate);
+        }
+        auto limit_m = compose_ortho(decomp.q, decomp.l);
+        m = intersect_metrics_general(m, limit_m);
+      }
+      set_symm(out, v, m);
+    };
+    parallel_for(mesh->nverts(), f);
+    metrics2 = Reals(out);
+  } while (!are_close(metrics, metrics2));
+  return metrics2;
+}
+
+/* with the symmetric kernels, a smooth graded metric field stays
+   within 1e-6 of the metric scale (measured: 4e-8; the fixed point
+   iteration itself stops at a relative change of 1e-10).
+   metrics whose intersections are degenerate (repeated eigenvalues
+   of inv(m1) * m2) are sensitive to any roundoff and may differ more */
+static void test_gradation_vs_general(Library* lib) {
+  Mesh mesh(lib);
+  build_box(&mesh, 1, 1, 1, 4, 4, 4);
+  auto coords = mesh.coords();
+  auto metrics_w = Write<Real>(mesh.nverts() * symm_dofs(3));
+  auto f = LAMBDA(LO v) {
+    auto x = get_vector<3>(coords, v);
+    auto r = rotate(PI * x[0], vector_3(0, 0, 1));
+    auto h = vector_3(
+        0.2 + 2.0 * x[0] * x[0], 0.7 + 0.3 * x[1], 0.4 + 0.2 * x[2]);
+    set_symm(metrics_w, v, compose_metric(r, h));
+  };
+  parallel_for(mesh.nverts(), f);
+  auto metrics = Reals(metrics_w);
+  auto graded = limit_metric_gradation(&mesh, metrics, 1.5);
+  auto reference = limit_metric_gradation_general(&mesh, metrics, 1.5);
+  CHECK(!are_close(graded, metrics));
+  CHECK(are_close(graded, reference, 1e-6, 1.0));
+}
+
 static void test_sort() {
   {
     LOs a({0, 1});
@@ -208,6 +350,31 @@ static void test_sort() {
   }
 }
 
+template <typename T>
+static void test_radix_sort(Int width) {
+  /* enough key sets to take the radix path, with
+     repeated and negative keys to check stability and order */
+  LO n = 10000;
+  HostWrite<T> keys(n * width);
+  std::uint64_t state = 42;
+  for (LO i = 0; i < n * width; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    keys[i] = static_cast<T>(static_cast<I64>(state >> 33) % 100 - 50);
+    if (i % 7 == 0) keys[i] *= 1000000;
+  }
+  auto radix_perm = radix_sort_by_keys(Read<T>(keys.write()), width);
+  auto perm = comparison_sort_by_keys(Read<T>(keys.write()), width);
+  CHECK(radix_perm == perm);
+  CHECK(sort_by_keys(Read<T>(keys.write()), width) == perm);
+}
+
+static void test_radix_sort() {
+  for (Int width = 1; width <= 3; ++width) {
+    test_radix_sort<LO>(width);
+    test_radix_sort<GO>(width);
+  }
+}
+
 static void test_scan() {
   {
     LOs scanned = offset_scan(LOs(3, 1));
@@ -217,6 +384,141 @@ static void test_scan() {
     LOs scanned = offset_scan(Read<I8>(3, 1));
     CHECK(scanned == Read<LO>(4, 0, 1));
   }
+  {
+    /* big enough to be split into chunks by threaded backends */
+    LO n = 100 * 1000;
+    LOs scanned = offset_scan(LOs(n, 1));
+    CHECK(scanned == Read<LO>(n + 1, 0, 1));
+    CHECK(sum(LOs(n, 1)) == n);
+    CHECK(max(LOs(n, 0, 1)) == n - 1);
+    Write<I8> marks(n);
+    auto f = LAMBDA(LO i) { marks[i] = ((i % 3) == 1); };
+    parallel_for(n, f);
+    auto marked = collect_marked(Read<I8>(marks));
+    CHECK(marked == Read<LO>(n / 3, 1, 3));
+  }
+}
+
+static void test_expr() {
+  Reals a({0.1, 0.5, 0.9, 1.3});
+  LOs b({1, 2, 3, 4});
+  CHECK(sum(lazy(a) >= 0.5 && lazy(a) < 1.0) == 2);
+  CHECK(eval(lazy(a) > 0.7 || lazy(a) < 0.2) == Read<I8>({1, 0, 1, 1}));
+  CHECK(max(lazy(a) * 2.0) == 2.6);
+  CHECK(min(lazy(b) - 1) == 0);
+  CHECK(eval(lazy(b) + lazy(b) * 2) == LOs({3, 6, 9, 12}));
+  CHECK(each_lt(a, 0.5) == Read<I8>({1, 0, 0, 0}));
+  CHECK(land_each(Read<I8>({1, 1, 0}), Read<I8>({1, 0, 1})) ==
+        Read<I8>({1, 0, 0}));
+}
+
+static void test_bits(Library* lib) {
+  LO n = 70;
+  Write<I8> a_w(n);
+  Write<I8> b_w(n);
+  auto f = LAMBDA(LO i) {
+    a_w[i] = (i % 3 == 0);
+    b_w[i] = (i % 2 == 0);
+  };
+  parallel_for(n, f);
+  Read<I8> a(a_w);
+  Read<I8> b(b_w);
+  Bits a_bits(a);
+  Bits b_bits(b);
+  CHECK(a_bits.nwords() == 3);
+  CHECK(a_bits.unpack() == a);
+  CHECK(count_bits(a_bits) == sum(a));
+  CHECK(land_bits(a_bits, b_bits).unpack() == land_each(a, b));
+  CHECK(lor_bits(a_bits, b_bits).unpack() == lor_each(a, b));
+  CHECK(collect_marked(a_bits) == collect_marked(a));
+  CHECK(pack_bits(lazy(LOs(n, 0, 1)) < 40).unpack() ==
+        each_lt(LOs(n, 0, 1), 40));
+  /* two items per root, sent to reversed destinations */
+  Remotes dests(Read<I32>(2 * n, 0), LOs(2 * n, 2 * n - 1, -1));
+  Dist dist(lib->self(), dests, 2 * n);
+  dist.set_roots2items(LOs(n + 1, 0, 2));
+  CHECK(dist.exch(a_bits).unpack() == dist.exch(a, 1));
+}
+
+static void test_pool() {
+#ifndef OMEGA_H_USE_KOKKOS
+  enable_pooling(true);
+  { Write<Real> a(1000); }
+  auto before = get_pool_stats();
+  CHECK(before.retained_bytes >= 1000 * sizeof(Real));
+  {
+    Write<Real> b(999, 1.0);
+    CHECK(b.get(998) == 1.0);
+  }
+  auto after = get_pool_stats();
+  CHECK(after.nhits == before.nhits + 1);
+  CHECK(after.retained_bytes == before.retained_bytes);
+  release_pooled_memory();
+  CHECK(get_pool_stats().retained_bytes == 0);
+  enable_pooling(false);
+#endif
+}
+
+static MemoryLabelStats get_label_stats(std::string const& name) {
+  for (auto& stats : get_memory_report()) {
+    if (stats.label == name) return stats;
+  }
+  Omega_h_fail("no memory label %s\n", name.c_str());
+}
+
+static void test_memory_labels() {
+  {
+    ScopedMemoryLabel label("test_memory_labels");
+    Write<Real> a(1000);
+    CHECK(get_label_stats("test_memory_labels").current_bytes ==
+          1000 * sizeof(Real));
+  }
+  auto stats = get_label_stats("test_memory_labels");
+  CHECK(stats.current_bytes == 0);
+  CHECK(stats.max_bytes == 1000 * sizeof(Real));
+  CHECK(stats.nallocs == 1);
+}
+
+static void test_profile(Library* lib) {
+  profile::enable(true);
+  {
+    profile::Region outer("test_profile_outer");
+    profile::Region inner("test_profile_inner");
+    Write<Real> a(10);
+  }
+  profile::enable(false);
+  std::stringstream stream;
+  profile::print(lib->self(), stream);
+  auto report = stream.str();
+  CHECK(report.find("\ntest_profile_outer ") != std::string::npos);
+  CHECK(report.find("\n  test_profile_inner ") != std::string::npos);
+  profile::reset();
+}
+
+static void test_trace(Library* lib) {
+  tracing::start(lib->self());
+  {
+    profile::Region region("test_trace_region");
+    CHECK(sum(Reals(100, 1.0)) == 100.0);
+  }
+  tracing::stop();
+  CHECK(!tracing::is_recording());
+  tracing::write(lib->self(), "test_trace.json");
+  std::string text;
+  {
+    std::ifstream file("test_trace.json");
+    CHECK(file.is_open());
+    std::stringstream stream;
+    stream << file.rdbuf();
+    text = stream.str();
+  }
+  std::remove("test_trace.json");
+  CHECK(text.find("{\"traceEvents\":[") == 0);
+  CHECK(text.find("\"name\":\"test_trace_region\",\"cat\":\"region\","
+                  "\"ph\":\"B\"") != std::string::npos);
+  CHECK(text.find("\"ph\":\"E\"") != std::string::npos);
+  CHECK(text.find("\"ph\":\"X\"") != std::string::npos);
+  CHECK(text.find("\"args\":{\"n\":100}") != std::string::npos);
 }
 
 static void test_fan_and_funnel() {
@@ -271,6 +573,31 @@ static void test_invert_adj() {
   CHECK(verts2tris.codes ==
         Read<I8>({make_code(0, 0, 0), make_code(0, 0, 2), make_code(0, 0, 1),
             make_code(0, 0, 2), make_code(0, 0, 0), make_code(0, 0, 1)}));
+  /* a fan of (n) triangles around vertex 0, numbered backwards,
+     long enough to take the segmented sort path */
+  LO n = 100;
+  HostWrite<LO> fan_tv2v(n * 3);
+  HostWrite<GO> fan_globals(n);
+  for (LO t = 0; t < n; ++t) {
+    fan_tv2v[t * 3 + 0] = 1 + t;
+    fan_tv2v[t * 3 + 1] = 0;
+    fan_tv2v[t * 3 + 2] = 1 + (t + 1) % n;
+    fan_globals[t] = 3 * (n - t);
+  }
+  auto fan_v2t = invert_adj(
+      Adj(LOs(fan_tv2v.write())), 3, n + 1, Read<GO>(fan_globals.write()));
+  auto v2vt = HostRead<LO>(fan_v2t.a2ab);
+  auto vt2t = HostRead<LO>(fan_v2t.ab2b);
+  auto vt_codes = HostRead<I8>(fan_v2t.codes);
+  CHECK(v2vt[1] == n);
+  for (LO vt = 0; vt < n; ++vt) {
+    CHECK(vt2t[vt] == n - 1 - vt);
+    CHECK(vt_codes[vt] == make_code(0, 0, 1));
+  }
+  for (LO v = 1; v <= n; ++v) {
+    CHECK(v2vt[v + 1] - v2vt[v] == 2);
+    CHECK(fan_globals[vt2t[v2vt[v]]] < fan_globals[vt2t[v2vt[v] + 1]]);
+  }
 }
 
 static bool same_adj(Int a[], Int b[]) {
@@ -362,6 +689,73 @@ static void test_find_unique() {
         LOs({0, 1, 0, 2, 3, 0, 1, 2, 2, 3}));
 }
 
+static void test_hashed_matching(Library* lib) {
+  enable_hashed_matching(true);
+  test_reflect_down();
+  test_find_unique();
+  Mesh a(lib);
+  build_box(&a, 1, 1, 1, 3, 4, 5);
+  enable_hashed_matching(false);
+  Mesh b(lib);
+  build_box(&b, 1, 1, 1, 3, 4, 5);
+  for (Int dim = 1; dim <= 3; ++dim) {
+    CHECK(a.nents(dim) == b.nents(dim));
+    CHECK(a.ask_verts_of(dim) == b.ask_verts_of(dim));
+    auto a_down = a.ask_down(dim, dim - 1);
+    auto b_down = b.ask_down(dim, dim - 1);
+    CHECK(a_down.ab2b == b_down.ab2b);
+    if (dim > 1) CHECK(a_down.codes == b_down.codes);
+  }
+}
+
+static void check_indset(Graph star, Read<I8> cands, Read<I8> indset) {
+  auto v2vv = HostRead<LO>(star.a2ab);
+  auto vv2v = HostRead<LO>(star.ab2b);
+  auto cands_h = HostRead<I8>(cands);
+  auto indset_h = HostRead<I8>(indset);
+  for (LO v = 0; v < cands_h.size(); ++v) {
+    if (!cands_h[v]) {
+      CHECK(!indset_h[v]);
+      continue;
+    }
+    bool has_chosen_neighbor = false;
+    for (auto vv = v2vv[v]; vv < v2vv[v + 1]; ++vv) {
+      if (indset_h[vv2v[vv]]) has_chosen_neighbor = true;
+    }
+    /* independent and maximal */
+    if (indset_h[v]) CHECK(!has_chosen_neighbor);
+    else CHECK(has_chosen_neighbor);
+  }
+}
+
+static void test_randomized_indset(Library* lib) {
+  Mesh mesh(lib);
+  build_box(&mesh, 1, 1, 0, 64, 2, 0);
+  /* equal qualities make the default algorithm resolve ties
+     one global number after the other along the strip */
+  auto quals = Reals(mesh.nverts(), 1.0);
+  auto cands = Read<I8>(mesh.nverts(), 1);
+  auto star = mesh.ask_star(VERT);
+  reset_indset_stats();
+  auto by_quality = find_indset(&mesh, VERT, quals, cands);
+  auto quality_stats = get_indset_stats();
+  CHECK(quality_stats.ncalls == 1);
+  check_indset(star, cands, by_quality);
+  enable_randomized_indset(true);
+  reset_indset_stats();
+  auto by_luby = find_indset(&mesh, VERT, quals, cands);
+  auto luby_stats = get_indset_stats();
+  enable_randomized_indset(false);
+  check_indset(star, cands, by_luby);
+  CHECK(luby_stats.max_rounds < quality_stats.max_rounds);
+  CHECK(luby_stats.nreductions < quality_stats.nreductions);
+  auto some_cands = each_eq_to(mesh.ask_globals(VERT), GO(3));
+  enable_randomized_indset(true);
+  auto one = find_indset(&mesh, VERT, quals, some_cands);
+  enable_randomized_indset(false);
+  CHECK(one == some_cands);
+}
+
 static void test_hilbert() {
   /* this is the original test from Skilling's paper */
   hilbert::coord_t X[3] = {5, 10, 20};  // any position in 32x32x32 cube
@@ -624,6 +1018,38 @@ static void test_refine_qualities(Library* lib) {
   CHECK(are_close(quals2, quals));
 }
 
+static void test_metric_qualities(Library* lib) {
+  Mesh mesh(lib);
+  build_box(&mesh, 1, 1, 1, 2, 2, 2);
+  auto coords = HostRead<Real>(mesh.coords());
+  HostWrite<Real> metrics(mesh.nverts() * symm_dofs(3));
+  for (LO v = 0; v < mesh.nverts(); ++v) {
+    auto x = get_vector<3>(coords, v);
+    auto l = vector_3(1 + x[0], 2 + 4 * x[1], 3 - x[2]);
+    auto m = compose_ortho(rotate(x[0], vector_3(0, 0, 1)), l);
+    auto mv = symm2vector(m);
+    for (Int i = 0; i < 6; ++i) metrics[v * 6 + i] = mv[i];
+  }
+  mesh.add_tag(VERT, "metric", symm_dofs(3), OMEGA_H_METRIC,
+      OMEGA_H_DO_OUTPUT, Reals(metrics.write()));
+  /* all elements use up-front determinants, a subset does not */
+  auto quals = measure_qualities(&mesh);
+  CHECK(quals == measure_qualities(&mesh, LOs(mesh.nelems(), 0, 1)));
+  /* against the original per-element maxdet_metric() formulation */
+  auto h_quals = HostRead<Real>(quals);
+  auto ev2v = HostRead<LO>(mesh.ask_elem_verts());
+  auto h_metrics = HostRead<Real>(mesh.get_array<Real>(VERT, "metric"));
+  for (LO e = 0; e < mesh.nelems(); ++e) {
+    Few<Vector<3>, 4> p;
+    Few<Matrix<3, 3>, 4> ms;
+    for (Int i = 0; i < 4; ++i) {
+      p[i] = get_vector<3>(coords, ev2v[e * 4 + i]);
+      ms[i] = get_symm<3>(h_metrics, ev2v[e * 4 + i]);
+    }
+    CHECK(h_quals[e] == metric_element_quality(p, maxdet_metric(ms)));
+  }
+}
+
 static void test_mark_up_down(Library* lib) {
   Mesh mesh(lib);
   build_box(&mesh, 1, 1, 0, 1, 1, 0);
@@ -632,6 +1058,236 @@ static void test_mark_up_down(Library* lib) {
   CHECK(mark_up(&mesh, VERT, TRI, Read<I8>({0, 1, 0, 0})) == Read<I8>({1, 0}));
 }
 
+static void ask_all_up_adjs(Mesh* mesh) {
+  for (Int high = 1; high <= mesh->dim(); ++high) {
+    for (Int low = 0; low < high; ++low) mesh->ask_up(low, high);
+  }
+}
+
+static void check_all_up_adjs(Mesh* mesh) {
+  for (Int high = 1; high <= mesh->dim(); ++high) {
+    for (Int low = 0; low < high; ++low) {
+      CHECK(mesh->has_adj(low, high));
+      auto kept = mesh->ask_up(low, high);
+      auto derived = invert_adj(mesh->ask_down(high, low),
+          simplex_degrees[high][low], mesh->nents(low),
+          mesh->ask_globals(high));
+      CHECK(kept.a2ab == derived.a2ab);
+      CHECK(kept.ab2b == derived.ab2b);
+      CHECK(kept.codes == derived.codes);
+    }
+  }
+}
+
+static void test_modify_up_adjs(Library* lib) {
+  Mesh mesh(lib);
+  build_box(&mesh, 1, 1, 1, 2, 2, 2);
+  classify_by_angles(&mesh, PI / 4);
+  mesh.add_tag(VERT, "size", 1, OMEGA_H_SIZE, OMEGA_H_DO_OUTPUT,
+      Reals(mesh.nverts(), 0.3));
+  auto opts = AdaptOpts(&mesh);
+  ask_all_up_adjs(&mesh);
+  CHECK(refine_by_size(&mesh, opts));
+  check_all_up_adjs(&mesh);
+  mesh.set_tag(VERT, "size", Reals(mesh.nverts(), 1.0));
+  ask_all_up_adjs(&mesh);
+  CHECK(coarsen_by_size(&mesh, opts));
+  check_all_up_adjs(&mesh);
+}
+
+static LO count_verts_below_x(Mesh* mesh, Real x) {
+  auto coords = mesh->coords();
+  return sum(lazy(unmap(LOs(mesh->nverts(), 0, 3), coords, 1)) < x);
+}
+
+static void test_adapt_region(Library* lib) {
+  Mesh mesh(lib);
+  build_box(&mesh, 1, 1, 1, 4, 4, 4);
+  classify_by_angles(&mesh, PI / 4);
+  auto xs = unmap(LOs(mesh.nverts(), 0, 3), mesh.coords(), 1);
+  auto elems_are_right = mark_up(&mesh, VERT, TET, each_gt(xs, 0.5));
+  Write<I32> class_ids(mesh.nelems());
+  auto f = LAMBDA(LO e) { class_ids[e] = elems_are_right[e] ? 0 : 1; };
+  parallel_for(mesh.nelems(), f);
+  mesh.add_tag(TET, "class_id", 1, OMEGA_H_INHERIT, OMEGA_H_DO_OUTPUT,
+      Read<I32>(class_ids));
+  mesh.add_tag(VERT, "size", 1, OMEGA_H_SIZE, OMEGA_H_DO_OUTPUT,
+      Reals(mesh.nverts(), 0.15));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.region_class_dims = {TET};
+  opts.region_class_ids = {1};
+  opts.nregion_layers = 0;
+  auto nleft = count_verts_below_x(&mesh, 0.45);
+  auto nright = mesh.nverts() - count_verts_below_x(&mesh, 0.55);
+  CHECK(adapt(&mesh, opts));
+  CHECK(count_verts_below_x(&mesh, 0.45) > nleft);
+  CHECK(mesh.nverts() - count_verts_below_x(&mesh, 0.55) == nright);
+  CHECK(!mesh.has_tag(TET, "adapt_region"));
+  auto region_edges = collect_marked(mark_adapt_region(&mesh, opts, EDGE));
+  auto region_lengths = unmap(region_edges, mesh.ask_lengths(), 1);
+  CHECK(max(region_lengths) <= opts.max_length_desired);
+}
+
+static void build_graded_box(Mesh* mesh) {
+  build_box(mesh, 1, 1, 1, 4, 4, 4);
+  classify_by_angles(mesh, PI / 4);
+  auto coords = mesh->coords();
+  Write<Real> sizes(mesh->nverts());
+  auto f = LAMBDA(LO v) { sizes[v] = (coords[v * 3] < 0.5) ? 0.1 : 0.8; };
+  parallel_for(mesh->nverts(), f);
+  mesh->add_tag(VERT, "size", 1, OMEGA_H_SIZE, OMEGA_H_DO_OUTPUT, Reals(sizes));
+}
+
+static void test_adapt_stats(Library* lib) {
+  Mesh mesh(lib);
+  build_graded_box(&mesh);
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  auto nverts_before = mesh.nverts();
+  AdaptStats stats;
+  CHECK(adapt(&mesh, opts, &stats));
+  CHECK(!stats.passes.empty());
+  GO nrefined = 0;
+  GO ncollapsed = 0;
+  for (auto& pass : stats.passes) {
+    if (!pass.modified) continue;
+    CHECK(pass.nrefined + pass.ncollapsed + pass.nswapped > 0);
+    CHECK(pass.nindset_rounds > 0);
+    nrefined += pass.nrefined;
+    ncollapsed += pass.ncollapsed;
+  }
+  CHECK(nrefined > 0);
+  CHECK(mesh.nverts() - nverts_before == nrefined - ncollapsed);
+  CHECK(stats.total_seconds >= stats.lengths_seconds + stats.quality_seconds);
+  CHECK(stats.quality_histogram.counts.size() ==
+        std::size_t(nhistogram_buckets));
+  GO nhist_elems = 0;
+  for (auto n : stats.quality_histogram.counts) nhist_elems += n;
+  CHECK(nhist_elems <= mesh.nelems());
+}
+
+static Int count_modifying_passes(AdaptStats const& stats) {
+  Int n = 0;
+  for (auto& pass : stats.passes) n += pass.modified;
+  return n;
+}
+
+static void test_adapt_budgets(Library* lib) {
+  {
+    Mesh mesh(lib);
+    build_graded_box(&mesh);
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    AdaptStats stats;
+    CHECK(adapt(&mesh, opts, &stats));
+    CHECK(stats.stop == ADAPT_DONE);
+    CHECK(count_modifying_passes(stats) > 1);
+  }
+  {
+    Mesh mesh(lib);
+    build_graded_box(&mesh);
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    opts.max_passes = 1;
+    AdaptStats stats;
+    CHECK(adapt(&mesh, opts, &stats));
+    CHECK(stats.stop == ADAPT_MAX_PASSES);
+    CHECK(count_modifying_passes(stats) == 1);
+    CHECK(stats.passes.back().modified);
+  }
+  {
+    Mesh mesh(lib);
+    build_graded_box(&mesh);
+    auto nelems = mesh.nelems();
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    opts.max_passes = 0;
+    AdaptStats stats;
+    adapt(&mesh, opts, &stats);
+    CHECK(stats.stop == ADAPT_MAX_PASSES);
+    CHECK(stats.passes.empty());
+    CHECK(mesh.nelems() == nelems);
+  }
+  {
+    Mesh mesh(lib);
+    build_graded_box(&mesh);
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    opts.max_seconds = 0.0;
+    AdaptStats stats;
+    CHECK(adapt(&mesh, opts, &stats));
+    CHECK(stats.stop == ADAPT_MAX_SECONDS);
+    CHECK(stats.passes.size() == 1);
+  }
+  {
+    Mesh mesh(lib);
+    build_graded_box(&mesh);
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    opts.min_changed_fraction = 1.0;
+    AdaptStats stats;
+    CHECK(adapt(&mesh, opts, &stats));
+    CHECK(stats.stop == ADAPT_FEW_CHANGES);
+    CHECK(count_modifying_passes(stats) == 1);
+  }
+}
+
+static void test_adj_cache_budget(Library* lib) {
+  Mesh a(lib);
+  build_box(&a, 1, 1, 1, 2, 2, 2);
+  auto star = a.ask_star(VERT);
+  auto dual = a.ask_dual();
+  auto up = a.ask_up(EDGE, TET);
+  Mesh b(lib);
+  build_box(&b, 1, 1, 1, 2, 2, 2);
+  reset_adj_cache_stats();
+  set_adj_cache_budget(1);
+  CHECK(b.ask_star(VERT) == star);
+  CHECK(b.ask_dual() == dual);
+  auto stats = get_adj_cache_stats();
+  CHECK(stats.nevictions > 0);
+  CHECK(stats.nrecomputes == 0);
+  CHECK(b.ask_up(EDGE, TET).ab2b == up.ab2b);
+  CHECK(b.ask_star(VERT) == star);
+  stats = get_adj_cache_stats();
+  CHECK(stats.nrecomputes > 0);
+  CHECK(stats.nmisses >= stats.nrecomputes);
+  for (Int dim = 1; dim <= 3; ++dim) CHECK(b.has_adj(dim, dim - 1));
+  CHECK(!b.has_adj(VERT, EDGE));
+  set_adj_cache_budget(std::numeric_limits<std::size_t>::max());
+}
+
+static void test_tag_handles(Library* lib) {
+  CHECK(intern_tag_name("handle_test") == intern_tag_name("handle_test"));
+  CHECK(get_tag_name(intern_tag_name("handle_test")) == "handle_test");
+  CHECK(find_tag_name("never_a_tag_name") == -1);
+  Mesh mesh(lib);
+  build_box(&mesh, 1, 1, 0, 1, 1, 0);
+  TagHandle<Real> foo("foo");
+  TagHandle<I8> foo_as_i8("foo");
+  CHECK(!mesh.has_tag(VERT, foo));
+  mesh.add_tag(VERT, "bar", 1, OMEGA_H_DONT_TRANSFER, OMEGA_H_DONT_OUTPUT,
+      Read<I8>(mesh.nverts(), 1));
+  mesh.add_tag(VERT, "foo", 1, OMEGA_H_DONT_TRANSFER, OMEGA_H_DONT_OUTPUT,
+      Reals(mesh.nverts(), 1.0));
+  CHECK(mesh.has_tag(VERT, foo));
+  CHECK(!mesh.has_tag(VERT, foo_as_i8));
+  CHECK(!mesh.has_tag(EDGE, foo));
+  mesh.set_tag(VERT, foo, Reals(mesh.nverts(), 2.0));
+  CHECK(mesh.get_array(VERT, foo) == mesh.get_array<Real>(VERT, "foo"));
+  CHECK(mesh.get_array(VERT, foo) == Reals(mesh.nverts(), 2.0));
+  mesh.remove_tag(VERT, "bar");
+  CHECK(mesh.get_array(VERT, foo) == Reals(mesh.nverts(), 2.0));
+  mesh.remove_tag(VERT, "foo");
+  CHECK(!mesh.has_tag(VERT, foo));
+  CHECK(!mesh.has_tag(VERT, "foo"));
+  mesh.add_tag(EDGE, "length", 1, OMEGA_H_LENGTH, OMEGA_H_DONT_OUTPUT,
+      Reals(mesh.nedges(), 1.0));
+  mesh.set_tag(VERT, TagHandle<Real>("coordinates"), mesh.coords());
+  CHECK(!mesh.has_tag(EDGE, "length"));
+}
+
 static void test_compare_meshes(Library* lib) {
   Mesh a(lib);
   build_box(&a, 1, 1, 0, 4, 4, 0);
@@ -865,11 +1521,19 @@ int main(int argc, char** argv) {
   test_form_ortho_basis();
   test_qr_decomps();
   test_eigen_cubic();
+  test_eigen_symms();
   test_least_squares();
   test_int128();
   test_repro_sum();
   test_sort();
+  test_radix_sort();
   test_scan();
+  test_expr();
+  test_bits(&lib);
+  test_pool();
+  test_memory_labels();
+  test_profile(&lib);
+  test_trace(&lib);
   test_intersect_metrics();
   test_fan_and_funnel();
   test_permute();
@@ -879,6 +1543,8 @@ int main(int argc, char** argv) {
   test_form_uses();
   test_reflect_down();
   test_find_unique();
+  test_hashed_matching(&lib);
+  test_randomized_indset(&lib);
   test_hilbert();
   test_bbox();
   test_build_from_elems2verts(&lib);
@@ -893,7 +1559,15 @@ int main(int argc, char** argv) {
   test_average_field(&lib);
   test_positivize();
   test_refine_qualities(&lib);
+  test_metric_qualities(&lib);
   test_mark_up_down(&lib);
+  test_modify_up_adjs(&lib);
+  test_adapt_region(&lib);
+  test_adapt_stats(&lib);
+  test_adapt_budgets(&lib);
+  test_gradation_vs_general(&lib);
+  test_adj_cache_budget(&lib);
+  test_tag_handles(&lib);
   test_compare_meshes(&lib);
   test_swap2d_topology(&lib);
   test_swap3d_loop(&lib);
@@ -0,0 +1,90 @@
+#ifndef VERT_HASH_HPP
+#define VERT_HASH_HPP
+
+#include <cstdint>
+
+#include "atomics.hpp"
+#include "internal.hpp"
+
+namespace Omega_h {
+
+/* An open-addressing hash table of entities keyed by their vertex
+   lists, regardless of orientation. Its slots hold entity indices,
+   or (-1) when empty; they are filled concurrently by compare-and-swap
+   and probed linearly.
+   The capacity is a power of two at least twice the number of
+   entities. Entities are spread over the table by their smallest
+   vertex, so that nearby entities land in nearby slots, and only
+   hashed by their other vertices within a stretch of (stride) slots. */
+
+struct VertHash {
+  Write<LO> slots;
+  LO stride;
+};
+
+VertHash make_vert_hash(LO nents, LO nverts);
+
+template <Int deg>
+INLINE void get_sorted_verts(LOs const& ev2v, LO e, LO v[]) {
+  for (Int i = 0; i < deg; ++i) v[i] = ev2v[e * deg + i];
+  for (Int i = 1; i < deg; ++i) {
+    for (Int j = i; j > 0 && v[j] < v[j - 1]; --j) swap2(v[j], v[j - 1]);
+  }
+}
+
+template <Int deg>
+INLINE LO hash_vert_list(LO const v[], LO capacity, LO stride) {
+  std::uint32_t h = 2166136261u;
+  for (Int i = 1; i < deg; ++i) {
+    h ^= static_cast<std::uint32_t>(v[i]);
+    h *= 16777619u;
+  }
+  h ^= h >> 15;
+  auto offset = static_cast<LO>(h % static_cast<std::uint32_t>(stride));
+  return (v[0] * stride + offset) & (capacity - 1);
+}
+
+template <Int deg>
+INLINE bool are_same_verts(LO const a[], LO const b[]) {
+  for (Int i = 0; i < deg; ++i)
+    if (a[i] != b[i]) return false;
+  return true;
+}
+
+/* inserts entity (e) with sorted vertices (v), or finds an entity
+   with the same vertices already there. returns the slot either way */
+template <Int deg>
+DEVICE LO insert_vert_list(
+    VertHash const& table, LOs const& ev2v, LO e, LO const v[]) {
+  auto capacity = table.slots.size();
+  auto slot = hash_vert_list<deg>(v, capacity, table.stride);
+  while (true) {
+    auto other = atomic_cas<LO>(&table.slots[slot], -1, e);
+    if (other == -1) return slot;
+    LO ov[deg];
+    get_sorted_verts<deg>(ev2v, other, ov);
+    if (are_same_verts<deg>(v, ov)) return slot;
+    slot = (slot + 1) & (capacity - 1);
+  }
+}
+
+/* returns the entity in the table with sorted vertices (v),
+   or (-1) if there is none */
+template <Int deg>
+DEVICE LO find_vert_list(
+    VertHash const& table, LOs const& ev2v, LO const v[]) {
+  auto capacity = table.slots.size();
+  auto slot = hash_vert_list<deg>(v, capacity, table.stride);
+  while (true) {
+    auto other = table.slots[slot];
+    if (other == -1) return -1;
+    LO ov[deg];
+    get_sorted_verts<deg>(ev2v, other, ov);
+    if (are_same_verts<deg>(v, ov)) return other;
+    slot = (slot + 1) & (capacity - 1);
+  }
+}
+
+}  // end namespace Omega_h
+
+#endif